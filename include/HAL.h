@@ -1,10 +1,13 @@
 #include <HAL/Common.h>
 #include <HAL/Algorithm.h>
 #include <HAL/Algorithms/AttachAttribute.h>
+#include <HAL/Algorithms/ClusterJets.h>
 #include <HAL/Algorithms/Cut.h>
+#include <HAL/Algorithms/DerivedValue.h>
 #include <HAL/Algorithms/ImportParticle.h>
 #include <HAL/Algorithms/ImportValue.h>
 #include <HAL/Algorithms/Monitor.h>
+#include <HAL/Algorithms/SelectExpression.h>
 #include <HAL/Algorithms/SelectParticle.h>
 #include <HAL/Algorithms/SelectRank.h>
 #include <HAL/Algorithms/SelectRefParticle.h>
@@ -18,11 +21,19 @@
 #include <HAL/AnalysisUtils.h>
 #include <HAL/CutAlgorithm.h>
 #include <HAL/CutOptimizer.h>
+#include <HAL/DenseIndexMap.h>
+#include <HAL/EtaPhiGrid.h>
+#include <HAL/EventArena.h>
+#include <HAL/Expression.h>
 #include <HAL/GenericData.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/Integrator.h>
 #include <HAL/Interpolator.h>
+#include <HAL/ObjectPool.h>
+#include <HAL/ParticleCollection.h>
 #include <HAL/PlotUtils.h>
+#include <HAL/RingBuffer.h>
+#include <HAL/StaticDataMap.h>
 
 /*!
  * \mainpage Welcome, to the HAL code reference.
@@ -20,6 +20,7 @@ namespace HAL
 class AnalysisData;
 class AnalysisTreeReader;
 class AnalysisTreeWriter;
+class EventArena;
 }
 // end forward declaration(s)
 
@@ -49,12 +50,15 @@ private:
                         fName,            //Name of algorithm
                         fTitle,           //Description of algorithm (may be empty)
                         fOutputFileName;  //Name of file output is send to
+  DataKey               fNameKey;         //!Interned name for fast data access
   Bool_t                fHasExecuted;     //True if algo has executed
   Bool_t                fAbort;           //True if algo has signaled an abort
+  EventArena           *fEventArena;      //!Arena of fDataList (looked up on first use)
 
   void       PrintAlgorithmHierarchy (TString indention);
   void       CounterSummaryHelper (TString indention);
   void       CutReportHelper (TString indention, Long64_t &base_number, Long64_t &prev_number);
+  void       ForgetData ();
 
 protected:
 
@@ -138,6 +142,26 @@ protected:
    */
   virtual void  Terminate (Option_t * /*options*/ = "") {}
 
+  //! Hook into the flow optimization done before processing
+  /*!
+   * This method is called once, after SlaveBegin, with the algorithm that 
+   * runs immediately before this one in the flow (one without 
+   * sub-algorithms). An algorithm may arrange to share work with it, as 
+   * long as every algorithm still publishes the same results.
+   * \param[in] previous The preceding algorithm
+   */
+  virtual void  Fuse (Algorithm * /*previous*/) {}
+
+  //! Tell the flow optimization whether the algorithm reads a result
+  /*!
+   * An algorithm is only offered to Fuse when the one after it is the sole
+   * reader of its result, so algorithms that read data from the UserData 
+   * should only return false for names they never read. The default 
+   * assumes any name may be read.
+   * \param[in] name Name of the algorithm whose result may be read
+   */
+  virtual bool  Reads (const TString & /*name*/) {return true;}
+
 public:
 
   // Constructor(s)/Destructor ------------------------------------------
@@ -178,7 +202,7 @@ public:
   void          CounterSummary ();
   void          CutReport ();
   void          DeleteAlgos ();
-  void          SetName (TString name) {fName = name;}
+  void          SetName (TString name) {fName = name; fNameKey = DataKey(name);}
   void          SetTitle (TString title) {fTitle = title;}
   void          SetOutputFileName (TString filename);
   //! \endcond
@@ -204,6 +228,8 @@ public:
   void          NotifyAlgo (Option_t *option);
   void          SlaveTerminateAlgo (Option_t *option);
   void          TerminateAlgo (Option_t *option);
+  void          FuseAlgos (Algorithm *flow = nullptr);
+  unsigned      CountReaders (const TString &name);
   //! \endcond
   // --------------------------------------------------------------------
   
@@ -266,6 +292,17 @@ public:
    * fashion.
    */
   AnalysisTreeWriter*   GetUserOutput ();
+
+  //! Convenience function for retrieving the EventArena object
+  /*!
+   * Convenience function for retrieving the EventArena object from the 
+   * common data store. Objects that only need to live for the current 
+   * event (particles, four-vectors, GenericData, etc...) should be 
+   * created here; the arena is reset after all algorithms have been 
+   * cleaned, so they need not be deleted in Clear. The arena is looked
+   * up once and remembered until the data list changes.
+   */
+  EventArena*           GetEventArena ();
   // --------------------------------------------------------------------
   
   // Data related -------------------------------------------------------
@@ -273,6 +310,13 @@ public:
   //! Retrieves the name of this algorithm
   TString       GetName () {return fName;}
 
+  //! Retrieves the interned name of this algorithm
+  /*!
+   * The key is created once when the algorithm is constructed and can be
+   * used for lookups in the AnalysisData without any string comparisons.
+   */
+  const DataKey& GetNameKey () const {return fNameKey;}
+
   //! Retrieves the title of this algorithm
   TString       GetTitle () {return fTitle;}
 
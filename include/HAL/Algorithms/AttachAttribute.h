@@ -28,6 +28,7 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <HAL/Common.h>
 #include <HAL/Exceptions.h>
@@ -40,6 +41,7 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
 
 
 namespace HAL
@@ -60,14 +62,20 @@ namespace internal
 class AugmentValueAlgo : public HAL::Algorithm {
 public:
   AugmentValueAlgo (TString name, TString title, TString input, TString attribute_name);
-  virtual ~AugmentValueAlgo () {}
+  virtual ~AugmentValueAlgo () {delete fOutput;}
 
 protected:
   virtual void  Exec (Option_t* /*option*/);
+  //! Drop the output's references to this event's particles before they are released
   virtual void  Clear (Option_t* /*option*/);
-  virtual void  StoreValue (HAL::AnalysisTreeReader*, HAL::ParticlePtr, long long) = 0;
+  //! Called once per event before StoreValue (for values that depend on the whole input)
+  virtual void  PrepareValues (HAL::AnalysisTreeReader*, HAL::GenericData*) {}
+  //! Compute the value to attach to a particle (returns false if there is none)
+  virtual bool  StoreValue (HAL::AnalysisTreeReader*, HAL::ParticlePtr, long long, long double&) = 0;
 
   TString   fInput, fAttributeLabel;
+  DataKey   fInputKey, fAttributeKey;
+  GenericData *fOutput; //! fInput plus the attribute overlay, reused between events
 };
 
 } /* internal */ 
@@ -85,8 +93,10 @@ namespace Algorithms
 //! Algorithm that attaches a decimal value to an existing set of particles
 /*!
  * This algorithm attaches information to a set of particles from either a branch in a TTree, a
- * specified property, or a value the user gives. The input particles are copied and the value is 
- * attached to the new particles. This algorithm needs one branch map to locate the value to 
+ * specified property, or a value the user gives. The input particles are not copied: the output 
+ * references them and the value is stored alongside, so it is visible through this algorithm and 
+ * every algorithm that selects from it (not through the input algorithm), as well as through
+ * GenericParticle::GetAttribute of the particles. This algorithm needs one branch map to locate the value to 
  * attach if attaching from a branch. The output from this algorithm may be accessed by this 
  * algorithm's name.\n\n
  * __Explaination of the branch map:__\n
@@ -170,21 +180,32 @@ public:
     fERank(property.EqualTo("rank_e", TString::kIgnoreCase)), 
     fEtRank(property.EqualTo("rank_et", TString::kIgnoreCase)), 
     fP3Rank(property.EqualTo("rank_p3", TString::kIgnoreCase)),
-    fRefCompare(!ref_particles.EqualTo("", TString::kIgnoreCase)) {}
+    fRefCompare(!ref_particles.EqualTo("", TString::kIgnoreCase)), 
+    fRefParticles(ref_particles), fNRankTables(0) {}
   virtual ~AttachAttribute () {}
 
-  bool          operator() (ParticlePtr lhs, ParticlePtr rhs);
-
 protected:
-  virtual void  StoreValue (HAL::AnalysisTreeReader*, HAL::ParticlePtr, long long);
-  void          Sort (ParticlePtrs &sl);
+  virtual bool  Reads (const TString &name) {return fInput.EqualTo(name) || fRefParticles.EqualTo(name);}
+  virtual void  PrepareValues (HAL::AnalysisTreeReader*, HAL::GenericData*);
+  virtual bool  StoreValue (HAL::AnalysisTreeReader*, HAL::ParticlePtr, long long, long double&);
+  GenericParticle::Kinematic  RankKinematic ();
 
 private:
+  // rank (1, 2, ...) of every row of one owner (0 if not ranked)
+  struct RankTable {
+    GenericData              *fOwner;
+    std::vector<long long>    fRank;
+  };
+
+  RankTable*  FindRankTable (const GenericData *owner);
+
   bool      fUserValue, fBranchValue, fPropertyValue;
   bool      fPtRank, fMRank, fERank, fEtRank, fP3Rank;
   bool      fRefCompare;
   double    fValue;
   TString   fBranchLabel, fRefParticles;
+  std::vector<RankTable>  fRankTables; //! reused between events
+  size_t                  fNRankTables; //! tables in use this event
 };
 
 } /* Algorithms */ 
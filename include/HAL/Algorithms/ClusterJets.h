@@ -0,0 +1,143 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ *
+ * \section LICENSE
+ *
+ * \section Description
+ *
+ * These classes are part of the generic algorithm framework. They do
+ * common tasks in H.E.P. analysis and aid in fast development of
+ * an analysis. Only importing and reconstruction algorithms will
+ * create particles; the others algorithms just suffle pointers to
+ * particles around.
+ */
+
+/// \todo Generic Algorithms: Make error messages more informative
+
+#ifndef HAL_ALGORITHM_CLUSTER_JETS
+#define HAL_ALGORITHM_CLUSTER_JETS
+
+#include <TString.h>
+#include <vector>
+#include <HAL/Common.h>
+#include <HAL/Exceptions.h>
+#include <HAL/Algorithm.h>
+#include <HAL/AnalysisData.h>
+#include <HAL/GenericParticle.h>
+#include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
+
+
+namespace HAL
+{
+
+namespace Algorithms
+{
+
+
+/*
+ * Reconstruction Algorithms
+ * */
+
+//! Algorithm that clusters the particles of another algorithm into jets
+/*!
+ * This algorithm runs a sequential recombination jet algorithm (anti-\f$ k_T \f$,
+ * \f$ k_T \f$ or Cambridge/Aachen) with radius R on the particles of the input
+ * algorithm (e.g. particle flow candidates or truth particles). Particles are
+ * combined by adding their four-vectors (E-scheme) and distances use the
+ * rapidity and azimuth of the particles. The jets are stored in a GenericData
+ * object in the UserData under the algorithm's name, ordered by decreasing
+ * \f$ p_T \f$. The input particles clustered into a jet are its "parents" and
+ * its charge is the sum of their charges, so the jets can be used by VecAddReco
+ * and SelectRefParticle like any other reconstructed particles.\n\n
+ * The particles are sorted into rapidity-azimuth tiles at least R wide, so the
+ * geometric nearest neighbour of a particle is only looked for in the nine
+ * tiles around it and clustering an event takes \f$ O(N^2) \f$ time instead of
+ * the \f$ O(N^3) \f$ of a direct implementation.\n\n
+ * __Example:__\n
+ * In your analysis file, do the following to build anti-\f$ k_T \f$ jets with R = 0.4
+ * and \f$ p_T \f$ above 20GeV:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ *
+ * a.AddAlgo(new HAL::Algorithms::ImportParticle("pf", "import particle flow candidates"));
+ *
+ * //...
+ *
+ * HAL::Algorithms::ClusterJets *jets = new HAL::Algorithms::ClusterJets("jets", "anti-kt R=0.4 jets",
+ *                                                                       "pf", "anti-kt", 0.4);
+ * jets->SetMinPt(20000);
+ * a.AddAlgo(jets);
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ */
+class ClusterJets : public Algorithm {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm
+   * \param[in] name Name of the algorithm. This can be used as the input to other
+   * algorithms.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] input Name of the algorithm whose particles are clustered.
+   * \param[in] algorithm Jet algorithm: "anti-kt", "kt" or "cambridge" (also "ca").
+   * \param[in] radius Jet radius R (must be positive).
+   * \sa ImportParticle, VecAddReco
+   */
+  ClusterJets (TString name, TString title, TString input,
+               TString algorithm = "anti-kt", double radius = 0.4);
+  virtual ~ClusterJets () {}
+
+  //! Only keep jets with a transverse momentum of at least pt
+  void          SetMinPt (double pt) {fMinPt = pt;}
+
+protected:
+  virtual void  Exec (Option_t* /*option*/);
+  virtual bool  Reads (const TString &name) {return fInputKey == DataKey::Find(name);}
+
+private:
+  // orders slots by decreasing transverse momentum
+  struct PtGreater {
+    PtGreater (const std::vector<double> *px, const std::vector<double> *py) : fPx(px), fPy(py) {}
+    bool operator() (size_t a, size_t b) const;
+    const std::vector<double> *fPx, *fPy;
+  };
+
+  // momentum factor of the distances (kt^2p)
+  double        MomentumFactor (double pt2) const;
+  // jet j's geometric distance to jet k (Delta R^2)
+  double        DeltaR2 (size_t j, size_t k) const;
+  // distance used to pick the next step (d_iB if jet j has no neighbour)
+  double        Distance (size_t j) const;
+  long          TileOf (double rap, double phi) const;
+  void          AddToTile (size_t j);
+  void          RemoveFromTile (size_t j);
+  // nearest neighbour of jet j among the jets in the tiles around it
+  void          FindNeighbour (size_t j);
+  void          SetKinematics (size_t j);
+
+  DataKey       fInputKey, fParentsKey;
+  int           fP; // exponent of kt: -1, 1 or 0
+  double        fR, fR2, fMinPt;
+
+  // per-event work space (kept to avoid reallocating every event);
+  // jets are stored in the slot of one of their constituents
+  std::vector<double>   fPx, fPy, fPz, fE, fRap, fPhi, fKt2p;
+  std::vector<long>     fNeighbour;      // -1 if there is none within R
+  std::vector<double>   fNeighbourDist;  // Delta R^2 to the neighbour (R^2 if none)
+  std::vector<size_t>   fActive;         // slots of the jets still being clustered
+  std::vector<size_t>   fActivePos;      // position of each slot in fActive
+  std::vector<long>     fFirst, fNext, fLast; // constituent lists (input indices)
+  std::vector<size_t>   fFinished;       // slots of the finished jets
+  long                  fNRap, fNPhi;
+  double                fRapMin, fRapCell, fPhiCell;
+  std::vector<long>     fTile, fTileHead, fTilePrev, fTileNext; // tiles as linked lists
+  ParticlePtrs          fConstituents;
+};
+
+} /* Algorithms */
+
+} /* HAL */
+
+#endif /* end of include guard: HAL_ALGORITHM_CLUSTER_JETS */
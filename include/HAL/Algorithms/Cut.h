@@ -42,6 +42,7 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/Expression.h>
 
 
 namespace HAL
@@ -90,6 +91,7 @@ public:
 
 protected:
   virtual void Exec (Option_t* /*option*/) {Passed();}
+  virtual bool Reads (const TString & /*name*/) {return false;}
 };
 
 
@@ -141,6 +143,14 @@ protected:
  *                                    "mc_neutrinos", "particle", ">=", 1,
  *                                    "di-jet", "particle", "==", 1));
  * ~~~~~~~~~~~~~~~~~~~~~~
+ * The result does not depend on the order in which the cuts are tested, so
+ * the algorithm keeps track of how often each cut passes and how long it takes
+ * to evaluate, and every 1000 events reorders them so that the cheapest and most
+ * decisive cuts (the ones most likely to fail for "and", or to pass for "or")
+ * are tested first. A cut whose algorithm stored nothing for the event fails.
+ * The first time a cut's algorithm has stored something, its value type is
+ * checked against the type of the cut, and a mismatch (or any other error
+ * reading the value) is raised as an exception.
  */
 class Cut : public CutAlgorithm {
 public:
@@ -167,9 +177,16 @@ public:
 
 protected:
   virtual void Exec (Option_t* /*option*/);
+  virtual bool Reads (const TString &name);
 
 private:
+  bool          Test (HAL::AnalysisData *data, HAL::internal::AlgoInfo *info);
+  void          Check (HAL::internal::AlgoInfo *info, HAL::GenericData *gen_data);
+  void          Reorder ();
+
   bool          fAnd, fOr;
+  Long64_t      fNEvents; // events evaluated (the order is revised periodically)
+  std::vector<size_t> fOrder; // evaluation order of fAlgorithms
 
 //public:
 //  struct AlgoInfo {
@@ -211,6 +228,51 @@ private:
   std::vector<HAL::internal::AlgoInfo*>    fAlgorithms;
 };
 
+
+//! Algorithm that cuts on an event selection expression
+/*!
+ * This algorithm passes events for which an expression such as
+ * "count(muons) >= 2 && value(met) > 30" is true. The expression is compiled
+ * once, when the algorithm is constructed. It may combine particle
+ * multiplicities (count) and values stored by other algorithms (value) with
+ * arithmetic, comparisons and logical operators, but not properties of
+ * individual particles. Events in which a referenced value does not exist
+ * fail the cut. See HAL::internal::Expression for the full syntax.\n\n
+ * __Example:__\n
+ * In your analysis file, do the following to create a cut:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ * 
+ * //...
+ *
+ * a.AddAlgo(new HAL::Algorithms::CutExpression("di-jet and neutrino cut", "make sure dijet and neutrino(s) exist", 
+ *                                              "count(mc_neutrinos) >= 1 && count(\"di-jet\") == 1"));
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ * (Quote names that contain operators or spaces, as in count("di-jet").)
+ */
+class CutExpression : public CutAlgorithm {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm
+   * \param[in] name Name of the algorithm. This can be used as the input to other 
+   * algorithms.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] expression Event selection expression (throws HALException if it can't be 
+   * parsed or uses particle properties).
+   * \sa Cut, SelectExpression
+   */
+  CutExpression (TString name, TString title, TString expression);
+  virtual ~CutExpression () {}
+
+protected:
+  virtual void Exec (Option_t* /*option*/);
+
+private:
+  internal::Expression  fExpression;
+};
+
 } /* Algorithms */ 
 
 namespace internal
@@ -219,31 +281,42 @@ namespace internal
 struct AlgoInfo {
   AlgoInfo () 
     : fEqual(false), fNotEqual(false), fLessThan(false), 
-    fGreaterThan(false), fLessThanEqual(false), fGreaterThanEqual(false) {}
+    fGreaterThan(false), fLessThanEqual(false), fGreaterThanEqual(false), 
+    fChecked(false), fCalls(0), fPasses(0), fCostSamples(0), fCost(0.0) {}
   virtual ~AlgoInfo () {}
   const char    *fName;
+  DataKey        fKey; // interned fName
   bool           fEqual, fNotEqual, fLessThan, fGreaterThan, fLessThanEqual, fGreaterThanEqual;
+  bool           fChecked; // the stored value type was checked
+  Long64_t       fCalls, fPasses, fCostSamples;
+  double         fCost; // mean seconds per evaluation (sampled)
   virtual bool  Eval (HAL::AnalysisData*, HAL::GenericData*) = 0;
+  //! True if values of the reference type (see GenericData::GetRefType) can be compared
+  virtual bool  Accepts (const TString & /*ref_type*/) {return true;}
 };
 
 struct BoolAlgoInfo : public AlgoInfo {
   bool           fValue;
   virtual bool  Eval (HAL::AnalysisData*, HAL::GenericData*);
+  virtual bool  Accepts (const TString &ref_type);
 };
 
 struct IntegerAlgoInfo : public AlgoInfo {
   long long      fValue;
   virtual bool  Eval (HAL::AnalysisData*, HAL::GenericData*);
+  virtual bool  Accepts (const TString &ref_type);
 };
 
 struct CountingAlgoInfo : public AlgoInfo {
   unsigned long long fValue;
   virtual bool  Eval (HAL::AnalysisData*, HAL::GenericData*);
+  virtual bool  Accepts (const TString &ref_type);
 };
 
 struct DecimalAlgoInfo : public AlgoInfo {
   long double    fValue;
   virtual bool  Eval (HAL::AnalysisData*, HAL::GenericData*);
+  virtual bool  Accepts (const TString &ref_type);
 };
 
 struct NParticlesAlgoInfo : public AlgoInfo {
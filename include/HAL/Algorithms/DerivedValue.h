@@ -0,0 +1,240 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ *
+ * \section LICENSE
+ *
+ * \section Description
+ *
+ * These classes are part of the generic algorithm framework. They do
+ * common tasks in H.E.P. analysis and aid in fast development of
+ * an analysis. Only importing and reconstruction algorithms will
+ * create particles; the others algorithms just suffle pointers to
+ * particles around.
+ */
+
+/// \todo Generic Algorithms: Make error messages more informative
+
+#ifndef HAL_ALGORITHM_DERIVED_VALUE
+#define HAL_ALGORITHM_DERIVED_VALUE
+
+#include <TString.h>
+#include <cstdarg>
+#include <type_traits>
+#include <vector>
+#include <HAL/Common.h>
+#include <HAL/Exceptions.h>
+#include <HAL/Algorithm.h>
+#include <HAL/AnalysisData.h>
+#include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
+
+
+namespace HAL
+{
+
+/*
+ * Generic base class algorithm
+ * */
+
+namespace internal
+{
+
+//! Base class for event quantities computed from other algorithms' output
+/*!
+ * The algorithm stores a GenericData under its name that refers to the
+ * value <name>:value, exactly like the ImportValue algorithms, so the
+ * value can be used by Cut, CutExpression, the monitors and StoreValue.
+ * Exec does not compute anything: it only discards the previous event's
+ * value. Compute is called by UserData the first time the value is
+ * requested in an event, so the value is computed at most once per event
+ * and not at all if nothing reads it. The algorithm has to be added
+ * before the algorithms using it. To write your own, derive from
+ * DerivedValueAlgo<bool>, <long long>, <unsigned long long> or
+ * <long double> and implement Compute (which may use GetUserData).
+ */
+template<typename ValueType>
+class DerivedValueAlgo : public HAL::Algorithm, public HAL::internal::ValueProvider {
+public:
+  DerivedValueAlgo (TString name, TString title);
+  virtual ~DerivedValueAlgo () {}
+
+  virtual void  Provide (HAL::AnalysisData *data);
+
+protected:
+  virtual void  Exec (Option_t* /*option*/);
+  //! Forget the UserData (it is deleted, with its providers, after SlaveTerminate)
+  virtual void  SlaveTerminate (Option_t* /*option*/);
+
+  virtual ValueType   Compute () = 0;
+
+  TString         fRefName, fUserDataLabel;
+  DataKey         fValueKey;
+
+private:
+  bool            fComputing;
+  HAL::AnalysisData *fProviderData; //! UserData this algorithm is registered with
+};
+
+} /* internal */
+
+
+
+namespace Algorithms
+{
+
+//! Algorithm that derives the scalar sum of the transverse momenta of several algorithms
+/*!
+ * The sum (\f$ H_T \f$) of the \f$ p_T \f$ of every particle in the given algorithms is
+ * computed when it is first needed in an event and stored in the UserData under
+ * <name>:value as a decimal. Algorithms without output for the event add nothing.
+ * __Example:__\n
+ * In your analysis file, do the following to cut on the \f$ H_T \f$ of jets and leptons:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ *
+ * //...
+ *
+ * a.AddAlgo(new HAL::Algorithms::ScalarSumPt("ht", "jet and lepton HT",
+ *                                            3, "jets", "electrons", "muons"));
+ *
+ * a.AddAlgo(new HAL::Algorithms::Cut("ht cut", "require large HT",
+ *                                    "and", 1,
+ *                                    "ht", "decimal", ">", 500.0));
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ */
+class ScalarSumPt : public HAL::internal::DerivedValueAlgo<long double> {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm
+   * \param[in] name Name of the algorithm. This can be used as the input to other
+   * algorithms.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] length Number of algorithms to sum over.
+   * \param[in] ... Names of the algorithms (const char*).
+   */
+  ScalarSumPt (TString name, TString title, long long length, ...);
+  virtual ~ScalarSumPt () {}
+
+protected:
+  virtual long double   Compute ();
+  virtual bool          Reads (const TString &name);
+
+private:
+  std::vector<DataKey>  fInputKeys;
+};
+
+//! Algorithm that derives the total number of particles in several algorithms
+/*!
+ * The number of particles in all the given algorithms (e.g. the lepton multiplicity)
+ * is computed when it is first needed in an event and stored in the UserData under
+ * <name>:value as a counting number.
+ * __Example:__\n
+ * In your analysis file, do the following to require exactly two leptons:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ *
+ * //...
+ *
+ * a.AddAlgo(new HAL::Algorithms::CountParticles("n leptons", "number of leptons",
+ *                                               2, "electrons", "muons"));
+ *
+ * a.AddAlgo(new HAL::Algorithms::Cut("dilepton", "require two leptons",
+ *                                    "and", 1,
+ *                                    "n leptons", "counting", "==", 2));
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ */
+class CountParticles : public HAL::internal::DerivedValueAlgo<unsigned long long> {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm
+   * \param[in] name Name of the algorithm. This can be used as the input to other
+   * algorithms.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] length Number of algorithms to count.
+   * \param[in] ... Names of the algorithms (const char*).
+   */
+  CountParticles (TString name, TString title, long long length, ...);
+  virtual ~CountParticles () {}
+
+protected:
+  virtual unsigned long long  Compute ();
+  virtual bool                Reads (const TString &name);
+
+private:
+  std::vector<DataKey>  fInputKeys;
+};
+
+} /* Algorithms */
+
+} /* HAL */
+
+
+
+/*
+ * Template definitions
+ * */
+
+template<typename ValueType>
+HAL::internal::DerivedValueAlgo<ValueType>::DerivedValueAlgo (TString name, TString title) :
+  HAL::Algorithm(name, title), fComputing(false), fProviderData(nullptr) {
+
+  if (std::is_same<ValueType, bool>::value)
+    fRefName = "bool";
+  else if (std::is_same<ValueType, long long>::value)
+    fRefName = "integer";
+  else if (std::is_same<ValueType, unsigned long long>::value)
+    fRefName = "counting";
+  else
+    fRefName = "decimal";
+  fUserDataLabel = TString::Format("%s:value", name.Data());
+  fValueKey = DataKey(fUserDataLabel);
+}
+
+template<typename ValueType>
+void  HAL::internal::DerivedValueAlgo<ValueType>::Exec (Option_t* /*option*/) {
+  HAL::AnalysisData *data = GetUserData();
+  HAL::GenericData *gen_data = GetEventArena()->New<GenericData>(GetName());
+
+  if (data != fProviderData) {
+    data->SetProvider(fValueKey, this);
+    fProviderData = data;
+  }
+  data->SetValue(GetNameKey(), gen_data);
+
+  // the value is computed again the first time it is requested
+  data->RemoveData(fUserDataLabel);
+
+  gen_data->SetRefName(fUserDataLabel, fValueKey);
+  gen_data->SetRefType(fRefName.Data());
+}
+
+template<typename ValueType>
+void  HAL::internal::DerivedValueAlgo<ValueType>::SlaveTerminate (Option_t* /*option*/) {
+  fProviderData = nullptr;
+}
+
+template<typename ValueType>
+void  HAL::internal::DerivedValueAlgo<ValueType>::Provide (HAL::AnalysisData *data) {
+  if (fComputing)
+    throw HAL::HALException(GetName().Prepend("Derived value depends on itself: ").Data());
+
+  ValueType value;
+
+  fComputing = true;
+  try {
+    value = Compute();
+  }
+  catch (...) {
+    fComputing = false;
+    throw;
+  }
+  fComputing = false;
+  data->SetValue(fValueKey, value);
+}
+
+#endif /* end of include guard: HAL_ALGORITHM_DERIVED_VALUE */
@@ -47,6 +47,7 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
 
 
 namespace HAL
@@ -72,8 +73,9 @@ protected:
   virtual void Init (Option_t* /*option*/);
   virtual void Exec (Option_t* /*option*/) {}
   virtual void Exec (unsigned n);
-  virtual void Clear (Option_t* /*option*/);
-  virtual TLorentzVector* MakeTLV (unsigned) = 0;
+  virtual bool Reads (const TString & /*name*/) {return false;}
+  // fills the four-vector columns for (at most) n particles and returns their number
+  virtual size_t  FillFourVectors (size_t n);
 
   bool      fIsCart, fIsE, fIsM,
             fIsCartMET, fIsPhiEtMET,
@@ -82,6 +84,8 @@ protected:
             fEta, fPhi, fM, fE, 
             fCharge, fID,
             fNEntriesName;
+  // four-vector components of the current event
+  std::vector<double>   fPxColumn, fPyColumn, fPzColumn, fEColumn;
 };
 
 } /* internal */ 
@@ -169,7 +173,6 @@ public:
 protected:
   using ImportParticleAlgo::Exec;
   virtual void Exec (Option_t* /*option*/);
-  virtual TLorentzVector* MakeTLV (unsigned);
 
 private:
   unsigned  fN;
@@ -26,6 +26,7 @@
 #include <HAL/AnalysisData.h>
 #include <HAL/AnalysisTreeReader.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
 
 
 namespace HAL
@@ -49,11 +50,12 @@ public:
 
 protected:
   virtual void  Exec (Option_t* /*option*/);
-  virtual void  Clear (Option_t* /*option*/);
+  virtual bool  Reads (const TString & /*name*/) {return false;}
 
   virtual ValueType   GetValue () = 0;
 
   TString   fValueLabel, fUserDataLabel, fRefName;
+  DataKey   fUserDataKey;
 };
 
 } /* internal */ 
@@ -452,27 +454,23 @@ HAL::internal::ImportValueAlgo<ValueType>::ImportValueAlgo (TString name, TStrin
   HAL::Algorithm(name, title) {
 
   fUserDataLabel = TString::Format("%s:value", name.Data());
+  fUserDataKey = DataKey(fUserDataLabel);
 }
 
 template<typename ValueType>
 void  HAL::internal::ImportValueAlgo<ValueType>::Exec (Option_t* /*option*/) {
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName());
+  HAL::GenericData *gen_data = GetEventArena()->New<GenericData>(GetName());
 
   data->SetValue(GetName(), gen_data);
 
   // Save actual value to user data
   data->SetValue(fUserDataLabel, GetValue());
 
-  gen_data->SetRefName(fUserDataLabel);
+  gen_data->SetRefName(fUserDataLabel, fUserDataKey);
   gen_data->SetRefType(fRefName.Data());
 }
 
-template<typename ValueType>
-void  HAL::internal::ImportValueAlgo<ValueType>::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
-}
-
 
 
 
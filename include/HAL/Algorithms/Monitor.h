@@ -48,10 +48,74 @@
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
 
+class TH1D;
+
 
 namespace HAL
 {
 
+namespace internal
+{
+
+class MonitorWorker;
+
+//! Compact record of one sampled event
+struct MonitorSnapshot {
+  MonitorSnapshot () : fEntry(-1), fExists(false), fIsValue(false), fN(0), fNValues(0), 
+    fValue(0.0), fLeadPt(0.0), fLeadEta(0.0), fLeadPhi(0.0), fSumPt(0.0) {}
+  Long64_t  fEntry;
+  bool      fExists, fIsValue;
+  size_t    fN, fNValues; // multiplicity (or names and filled names in UserData)
+  double    fValue, fLeadPt, fLeadEta, fLeadPhi, fSumPt;
+};
+
+/*
+ * Base for monitors that sample every N-th event: the event loop only fills
+ * a MonitorSnapshot and queues it, a background thread does the formatting
+ * or fills histograms
+ * */
+class SamplingMonitorAlgo : public HAL::Algorithm {
+public:
+  SamplingMonitorAlgo (TString name, TString title, long long period, std::ostream &os);
+  virtual ~SamplingMonitorAlgo ();
+
+  //! Fill histograms instead of printing every snapshot (a summary is printed at the end)
+  /*!
+   * At SlaveTerminate the histograms are handed to "UserOutput", which writes them to
+   * the output file next to the trees. Without "UserOutput" they stay with the monitor.
+   */
+  void          SetHistograms (bool histograms = true) {fHistograms = histograms;}
+  //! Histograms filled so far (empty once they are handed to "UserOutput")
+  const std::vector<TH1D*>& GetHistograms () const {return fHists;}
+  //! Number of snapshots that can wait for the background thread (default 1024)
+  void          SetBufferSize (size_t size) {fBufferSize = size;}
+
+protected:
+  virtual void  SlaveBegin (Option_t* /*option*/);
+  virtual void  Exec (Option_t* /*option*/);
+  virtual void  SlaveTerminate (Option_t* /*option*/);
+
+  //! Record the current event (event loop)
+  virtual void  Sample (HAL::AnalysisData *data, MonitorSnapshot &snapshot) = 0;
+  //! Print one snapshot (background thread)
+  virtual void  Format (const MonitorSnapshot &snapshot, std::ostream &os) = 0;
+  //! Create the histograms and fill them (background thread after SlaveBegin)
+  virtual void  Book (std::vector<TH1D*> &histograms) = 0;
+  virtual void  Fill (const MonitorSnapshot &snapshot, std::vector<TH1D*> &histograms) = 0;
+
+private:
+  friend class MonitorWorker;
+
+  long long         fN, fNEvents;
+  std::ostream     *fOS;
+  bool              fHistograms;
+  size_t            fBufferSize;
+  MonitorWorker    *fWorker; //!
+  std::vector<TH1D*> fHists; //!
+};
+
+} /* internal */ 
+
 namespace Algorithms
 {
 
@@ -60,10 +124,17 @@ namespace Algorithms
  * Monitoring Algorithms
  * */
 
-//! Algorithm that prints the content of an algorithm to a given ostream.
+//! Algorithm that reports the content of an algorithm to a given ostream.
 /*!
  * This algorithm is helpful in monitoring the particles produced or value stored by another
- * generic algorithm.
+ * generic algorithm. Every period-th event that reaches it, the multiplicity, the leading
+ * particle and the scalar sum of the transverse momenta (or the stored value) are recorded.
+ * The records are formatted to the stream by a background thread, so monitoring costs the
+ * event loop little more than the record itself. With SetHistograms the records are
+ * collected into histograms instead and only their summary is printed at the end. If the
+ * background thread falls behind, records are dropped rather than slowing down the event
+ * loop; the number dropped is printed at the end. While events are processed the stream
+ * should not be written to by anything else.
  * __Example:__\n
  * In your analysis file, do the following to monitor the output of an algorithm:
  *
@@ -80,7 +151,7 @@ namespace Algorithms
  *                                                 "leading pt jet", 100));
  * ~~~~~~~~~~~~~~~~~~~~~~
  */
-class MonitorAlgorithm : public HAL::Algorithm {
+class MonitorAlgorithm : public HAL::internal::SamplingMonitorAlgo {
 public:
   //! Constructor
   /*!
@@ -93,33 +164,40 @@ public:
    * \param[in] os Stream to pipe all output to.
    */
   MonitorAlgorithm (TString name, TString title, TString input, long long period = 1, std::ostream &os = std::cout) :
-    Algorithm(name, title), fN(period), fInput(input), fOS(&os) {}
+    SamplingMonitorAlgo(name, title, period, os), fInput(input), fInputKey(input) {}
   virtual ~MonitorAlgorithm () {}
 
 protected:
-  virtual void Exec (Option_t* /*option*/);
+  virtual bool  Reads (const TString &name) {return fInput.EqualTo(name);}
+  virtual void  Sample (HAL::AnalysisData *data, HAL::internal::MonitorSnapshot &snapshot);
+  virtual void  Format (const HAL::internal::MonitorSnapshot &snapshot, std::ostream &os);
+  virtual void  Book (std::vector<TH1D*> &histograms);
+  virtual void  Fill (const HAL::internal::MonitorSnapshot &snapshot, std::vector<TH1D*> &histograms);
 
 private:
-  long long      fN;
   TString        fInput;
-  std::ostream  *fOS;
+  DataKey        fInputKey;
 };
 
 
 /*
- * Prints the contents of "UserData" to the given ostream
+ * Reports how many names "UserData" holds every period-th event
  * */
-class MonitorUserData : public HAL::Algorithm {
+class MonitorUserData : public HAL::internal::SamplingMonitorAlgo {
 public:
-  MonitorUserData (TString name, TString title, std::ostream &os = std::cout) :
-    Algorithm(name, title), fOS(&os) {}
+  MonitorUserData (TString name, TString title, long long period = 1, std::ostream &os = std::cout) :
+    SamplingMonitorAlgo(name, title, period, os) {}
+  MonitorUserData (TString name, TString title, std::ostream &os) :
+    SamplingMonitorAlgo(name, title, 1, os) {}
   virtual ~MonitorUserData () {}
 
 protected:
-  virtual void Exec (Option_t* /*option*/);
-
-private:
-  std::ostream  *fOS;
+  // only counts the names, so the outputs of other algorithms can still be fused
+  virtual bool  Reads (const TString & /*name*/) {return false;}
+  virtual void  Sample (HAL::AnalysisData *data, HAL::internal::MonitorSnapshot &snapshot);
+  virtual void  Format (const HAL::internal::MonitorSnapshot &snapshot, std::ostream &os);
+  virtual void  Book (std::vector<TH1D*> &histograms);
+  virtual void  Fill (const HAL::internal::MonitorSnapshot &snapshot, std::vector<TH1D*> &histograms);
 };
 
 } /* Algorithms */ 
@@ -127,4 +205,3 @@ private:
 } /* HAL */ 
 
 #endif /* end of include guard: HAL_ALGORITHM_MONITOR */
-
@@ -0,0 +1,106 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ *
+ * \section LICENSE
+ * 
+ * \section Description
+ *
+ * These classes are part of the generic algorithm framework. They do
+ * common tasks in H.E.P. analysis and aid in fast development of
+ * an analysis. Only importing and reconstruction algorithms will
+ * create particles; the others algorithms just suffle pointers to
+ * particles around.
+ */
+
+/// \todo Generic Algorithms: Add chi-squared minimization algorithm
+/// \todo Generic Algorithms: Add parent selection algorithm
+/// \todo Generic Algorithms: Add merging algorithm
+/// \todo Generic Algorithms: Add monitor for UserData algorithm
+/// \todo Generic Algorithms: Add parent/child traversal algorithms
+/// \todo Generic Algorithms: Make error messages more informative
+
+#ifndef HAL_ALGORITHM_SELECT_EXPRESSION
+#define HAL_ALGORITHM_SELECT_EXPRESSION
+
+#include <TString.h>
+#include <vector>
+#include <HAL/Common.h>
+#include <HAL/Exceptions.h>
+#include <HAL/Algorithm.h>
+#include <HAL/AnalysisData.h>
+#include <HAL/GenericParticle.h>
+#include <HAL/GenericData.h>
+#include <HAL/ParticleCollection.h>
+#include <HAL/Expression.h>
+#include <HAL/Algorithms/SelectParticle.h>
+
+
+namespace HAL
+{
+
+namespace Algorithms
+{
+
+//! Algorithm that selects particles with a selection expression
+/*!
+ * This algorithm selects the particles for which an expression such as
+ * "pt > 20 && |eta| < 2.5 && id in {11, -11, 13, -13}" is true. The
+ * expression is compiled once, when the algorithm is constructed, and each
+ * event's particles are then selected in a single pass, so one
+ * SelectExpression replaces a chain of SelectParticle algorithms and their
+ * intermediate results. Besides the kinematics, id and charge of the
+ * particle, an expression can use the particle's attributes, the number of
+ * particles in another algorithm (count), the distance to the nearest
+ * particle of another algorithm (mindr), and values stored by other
+ * algorithms (value). See HAL::internal::Expression for the full syntax.
+ * No particles are selected in events where a referenced value does not
+ * exist.\n\n
+ * __Example:__\n
+ * To select isolated, central leptons:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ *
+ * a.AddAlgo(new HAL::Algorithms::ImportParticle("leptons", "import basic leptons"));
+ * a.AddAlgo(new HAL::Algorithms::ImportParticle("jets", "import basic jets"));
+ *
+ * //...
+ * 
+ * a.AddAlgo(new HAL::Algorithms::SelectExpression("good leptons", "central isolated e/mu", 
+ *                                                 "leptons",
+ *                                                 "pt > 20 && |eta| < 2.5 && "
+ *                                                 "id in {11, -11, 13, -13} && mindr(jets) > 0.4"));
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ */
+class SelectExpression : public internal::FilterParticleAlgo {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm
+   * \param[in] name Name of the algorithm. This can be used as the input to other 
+   * algorithms.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] input Name of algorithm to select from.
+   * \param[in] expression Selection expression (throws HALException if it can't be parsed).
+   * \sa SelectParticle, CutExpression
+   */
+  SelectExpression (TString name, TString title, TString input, TString expression);
+  virtual ~SelectExpression () {}
+
+protected:
+  virtual bool FilterPredicate (HAL::ParticlePtr);
+  virtual bool FilterCollection (const HAL::ParticleCollection&, std::vector<char>&);
+
+private:
+  internal::Expression  fExpression;
+  ParticlePtrs          fSingle; // one particle collection for FilterPredicate
+  ParticleCollection    fSingleCollection;
+  std::vector<char>     fSingleKeep;
+};
+
+} /* Algorithms */ 
+
+} /* HAL */ 
+
+#endif /* end of include guard: HAL_ALGORITHM_SELECT_EXPRESSION */
@@ -47,6 +47,8 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
+#include <HAL/ParticleCollection.h>
 
 
 namespace HAL
@@ -66,16 +68,28 @@ namespace internal
 class FilterParticleAlgo : public Algorithm {
 public:
   FilterParticleAlgo (TString name, TString title, TString input) :
-    Algorithm(name, title), fInput(input) {}
-  virtual ~FilterParticleAlgo () {}
+    Algorithm(name, title), fInput(input), fInputKey(input), fOutput(nullptr), fInputData(nullptr) {}
+  virtual ~FilterParticleAlgo () {delete fOutput;}
 
   virtual bool FilterPredicate (HAL::ParticlePtr) = 0;
+  //! Columnar version of FilterPredicate
+  /*!
+   * Fills keep[i] for every particle in the collection and returns true, or
+   * returns false if the selection can only be done particle by particle.
+   */
+  virtual bool FilterCollection (const HAL::ParticleCollection&, std::vector<char>&) {return false;}
   
 protected:
   virtual void Exec (Option_t* /*option*/);
+  //! Drop the output's references to this event's particles before they are released
   virtual void Clear (Option_t* /*option*/);
 
-  TString fInput;
+  TString           fInput;
+  DataKey           fInputKey;
+  std::vector<char> fKeep; // reused between events
+  GenericData      *fOutput; //! selection over fInput, reused between events
+  // container being filtered while Exec calls FilterPredicate (attributes are read through it)
+  GenericData      *fInputData; //!
 };
 
 } /* internal */ 
@@ -104,6 +118,14 @@ namespace Algorithms
  * | :-----------------: | :---------------: | :--: | :----: | :------------------: | :-: |
  * |  ==   | != | > | >= | < | <= |
  * _Note:_ = may also be used in place of ==.\n\n
+ * When a SelectParticle runs right after the SelectParticle it selects from,
+ * and nothing else reads that selection, the two are fused: the first one 
+ * evaluates both selections in a single pass over its own input, testing 
+ * the second one only on the particles that passed the first. Chains of any
+ * length are fused this way (except for selections on custom attributes). 
+ * Every algorithm still counts its own particles and publishes its own 
+ * GenericData under its name, but the GenericData is only filled when it is
+ * first requested, and its source is the input of the whole chain.\n\n
  * __Examples:__\n
  * In your analysis file, do the following to select the muons with \f$ p_T \f$ greater than or equal to 50GeV:
  *
@@ -149,7 +171,7 @@ namespace Algorithms
  *                                               -16, -14, -12, 12, 14, 16));
  * ~~~~~~~~~~~~~~~~~~~~~~
  */
-class SelectParticle : public internal::FilterParticleAlgo {
+class SelectParticle : public internal::FilterParticleAlgo, public internal::ValueProvider {
 public:
   //! Constructor
   /*!
@@ -197,19 +219,50 @@ public:
       int length, ...);
   virtual ~SelectParticle () {}
 
+  //! Fill the output of a fused selection when it is first requested
+  virtual void Provide (HAL::AnalysisData *data);
+
 protected:
+  virtual void Exec (Option_t* /*option*/);
+  virtual void Clear (Option_t* /*option*/);
+  virtual void Fuse (Algorithm *previous);
+  virtual bool Reads (const TString &name) {return fInput.EqualTo(name);}
   virtual bool FilterPredicate(HAL::ParticlePtr);
+  virtual bool FilterCollection (const HAL::ParticleCollection&, std::vector<char>&);
 
 private:
+  // what is compared and how, both fixed at construction
+  enum Source {kKinematicValue, kChargeValue, kIDValue, kAttributeValue};
+  enum Comparison {kEqual, kNotEqual, kLessThan, kGreaterThan, kLessThanEqual, 
+                   kGreaterThanEqual, kInside, kOutside, kInList, kUnknown};
+
   void      Setup ();
+  bool      Test (double property);
+  void      PrepareFused ();
+  void      PublishFused ();
+  // keeps the rows (of particles) that pass the selection
+  void      FilterRows (const HAL::ParticleCollection &particles, 
+                        const std::vector<size_t> &rows, std::vector<size_t> &passed);
+  template <class T>
+  void      Compare (const T *property, size_t n, std::vector<char> &keep);
 
   double    fHighLimit, fLowLimit;
-  bool      fPt, fM, fE, fEt, fP3, fEta, fPhi, fCharge, fID, fAttribute;
-  bool      fEqual, fNotEqual, fLessThan, fGreaterThan, fLessThanEqual, fGreaterThanEqual;
-  bool      fIn, fOut;
-  bool      fSingleEnd, fWindow, fList;
+  Source    fSource;
+  GenericParticle::Kinematic fKinematic;
+  Comparison fComparison;
   TString   fProperty;
-  std::vector<double> fListValues;
+  DataKey   fPropertyKey;
+  std::vector<double> fListValues; // sorted for binary searches
+  std::vector<double> fValues; // reused between events
+  std::vector<long double> fAttributeValues; // reused between events
+
+  // chains of selections fused by the flow optimization (see Fuse)
+  SelectParticle *fLeader; //! first selection of the chain (nullptr if not fused)
+  SelectParticle *fPrevious; //! selection this one reads from
+  std::vector<SelectParticle*> fFollowers; //! rest of the chain (leader only)
+  Long64_t  fFusedEvent; //! chain evaluations (leader) or the last one published (followers)
+  GenericData *fChainInput; //! input of the chain for this event (leader only)
+  std::vector<size_t> fRows; //! rows of fChainInput this selection keeps
 };
 
 } /* Algorithms */ 
@@ -35,6 +35,7 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <HAL/Common.h>
 #include <HAL/Exceptions.h>
@@ -47,6 +48,7 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
 
 
 namespace HAL
@@ -65,19 +67,28 @@ namespace internal
 class NthElementAlgo : public HAL::Algorithm {
 public:
   NthElementAlgo (TString name, TString title, TString input, unsigned n) :
-    HAL::Algorithm(name, title), fN(n), fInput(input) {}
-  virtual ~NthElementAlgo () {}
+    HAL::Algorithm(name, title), fN(n), fInput(input), fInputKey(input), fOutput(nullptr) {}
+  virtual ~NthElementAlgo () {delete fOutput;}
 
-  virtual TString   SortTag () = 0;
-  virtual bool      operator() (HAL::ParticlePtr, HAL::ParticlePtr) = 0;
-  virtual void      Sort (HAL::ParticlePtrs&) = 0;
+  //! Property and direction of the ranking
+  /*!
+   * The sorted order is taken from GenericData::GetSortedIndices of the
+   * input's owner, so it is shared with every other ranking of the event.
+   */
+  virtual GenericParticle::Kinematic  SortKinematic () = 0;
+  virtual bool                        SortDescending () = 0;
 
 protected:
   virtual void      Exec (Option_t* /*option*/);
+  //! Drop the output's references to this event's particles before they are released
   virtual void      Clear (Option_t* /*option*/);
+  virtual bool      Reads (const TString &name) {return fInput.EqualTo(name);}
 
   unsigned           fN;
   TString            fInput;
+  DataKey            fInputKey;
+  GenericData       *fOutput; //! selection over fInput, reused between events
+  std::vector<size_t> fMembers; //! position in fInput + 1 of each owner particle (0 if absent)
 };
 
 } /* internal */ 
@@ -135,9 +146,8 @@ public:
               TString property, TString end = "high");
   virtual ~SelectRank () {}
 
-  virtual TString       SortTag ();
-  virtual bool          operator() (ParticlePtr, ParticlePtr);
-  virtual void          Sort (ParticlePtrs&);
+  virtual GenericParticle::Kinematic  SortKinematic ();
+  virtual bool                        SortDescending ();
 
 protected:
   bool      fPt, fM, fE, fEt, fP3, fHigh, fLow;
@@ -48,6 +48,8 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
+#include <HAL/EtaPhiGrid.h>
 
 
 namespace HAL
@@ -68,16 +70,31 @@ namespace internal
 class FilterRefParticleAlgo : public Algorithm {
 public:
   FilterRefParticleAlgo (TString name, TString title, TString input, TString others) :
-    Algorithm(name, title), fInput(input), fOthers(others) {}
-  virtual ~FilterRefParticleAlgo () {}
+    Algorithm(name, title), fInput(input), fOthers(others), 
+    fInputKey(input), fOthersKey(others), fParentsKey("parents"), fOutput(nullptr) {}
+  virtual ~FilterRefParticleAlgo () {delete fOutput;}
 
   virtual bool FilterPredicate (HAL::ParticlePtr, HAL::ParticlePtr) = 0;
+  //! \f$ \Delta R \f$ at and beyond which FilterPredicate is always true (0 if there is none)
+  /*!
+   * If this is positive, the references are indexed in an EtaPhiGrid and
+   * each particle is only compared to the references around it.
+   */
+  virtual double PredicateReach () {return 0.0;}
 
 protected:
   virtual void Exec (Option_t* /*option*/);
+  //! Drop the output's references to this event's particles before they are released
   virtual void Clear (Option_t* /*option*/);
+  virtual bool Reads (const TString &name) {return fInput.EqualTo(name) || fOthers.EqualTo(name);}
+  //! A particle is never compared to itself or to a copy built from the same parents
+  bool         IsSameParticle (HAL::ParticlePtr reference, HAL::ParticlePtr particle);
 
   TString fInput, fOthers;
+  DataKey fInputKey, fOthersKey, fParentsKey;
+  GenericData *fOutput; //! selection over fOthers, reused between events
+  internal::EtaPhiGrid  fGrid; //! references of the current event
+  std::vector<size_t>   fCandidates; //! references near the current particle
 };
 
 } /* internal */ 
@@ -156,6 +173,7 @@ public:
 
 protected:
   virtual bool FilterPredicate (HAL::ParticlePtr, HAL::ParticlePtr);
+  virtual double PredicateReach ();
 
 private:
   double    fHighLimit, fLowLimit;
@@ -72,12 +72,16 @@ public:
 
 protected:
   virtual void    Exec (Option_t* /*option*/);
+  virtual bool    Reads (const TString &name) {return fInput.EqualTo(name);}
   virtual void    StoreValue (HAL::AnalysisTreeWriter*, long long, HAL::ParticlePtr) = 0;
 
-  bool            fSearchedForAttributes;
+  bool            fUsesAttributes, fSearchedForAttributes;
   TString         fBranchName, fInput, fNParticles;
-  std::map<TString, bool>     fAttributeFlags;
-  std::map<TString, TString>  fAttributeLabels;
+  DataKey         fInputKey, fNParticlesKey;
+  std::vector<DataKey>                    fAttributeKeys;
+  std::vector<TString>                    fAttributeLabels;
+  // this event's attribute columns (same order as fAttributeKeys)
+  std::vector<std::vector<long double> >  fAttributeValues;
 };
 
 } /* internal */ 
@@ -142,6 +146,48 @@ private:
                   fTreeName;
 };
 
+//! Algorithm that stores the value of a value algorithm to a TTree
+/*!
+ * This algorithm writes the value referenced by another algorithm (any of the
+ * ImportValue algorithms or a derived value such as ScalarSumPt) to a branch.
+ * Nothing is written for events in which the input has no output.
+ * __Example:__\n
+ * In your analysis file, do the following to store the \f$ H_T \f$ of the jets:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Analysis a("sample analysis", "", "truth");
+ * 
+ * a.AddAlgo(new HAL::Algorithms::ImportParticle("jets", "import basic jet objects"));
+ *
+ * a.AddAlgo(new HAL::Algorithms::ScalarSumPt("ht", "jet HT", 1, "jets"));
+ *
+ * a.AddAlgo(new HAL::Algorithms::StoreValue("store ht", "store HT", "ht", "ht"));
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ */
+class StoreValue : public HAL::Algorithm {
+public:
+  //! Constructor
+  /*!
+   * Initializes the algorithm.
+   * \param[in] name Name of the algorithm.
+   * \param[in] title Description of the algorithm. Can be an empty string.
+   * \param[in] input Name of the algorithm whose value is stored.
+   * \param[in] bname Branch to store as.
+   * \param[in] tname Tree to store in.
+   */
+  StoreValue (TString name, TString title, TString input, TString bname, TString tname = "");
+  virtual ~StoreValue () {}
+
+protected:
+  virtual void  Init (Option_t* /*option*/);
+  virtual void  Exec (Option_t* /*option*/);
+  virtual bool  Reads (const TString &name) {return fInput.EqualTo(name);}
+
+private:
+  TString         fInput, fBranchName, fTreeName;
+  DataKey         fInputKey, fBranchKey;
+};
+
 } /* Algorithms */ 
 
 } /* HAL */ 
@@ -34,6 +34,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <iostream>
 #include <HAL/Common.h>
@@ -47,6 +49,7 @@
 #include <HAL/AnalysisTreeWriter.h>
 #include <HAL/GenericParticle.h>
 #include <HAL/GenericData.h>
+#include <HAL/EventArena.h>
 
 
 namespace HAL
@@ -68,6 +71,14 @@ namespace Algorithms
  * algorithms (i.e. "length"). This algorithm may return no particles if no unique combination 
  * can be found. The particles from this algorithm are stored in a GenericData object in the 
  * UserData under the algorithm's name.\n\n
+ * Tuples are tracked as bitmasks over the distinct constituents of the event (identified by
+ * origin and origin index) and duplicates are dropped through a hash set of masks. When the
+ * same algorithm is given several times in a row only ordered combinations of its particles
+ * are enumerated.\n\n
+ * The four-vector and charge of every tuple are summed as the tuple grows, so the
+ * enumeration can be pruned with SetMaxMass, SetCharge and SetMaxCandidates. Tuples that
+ * can no longer pass these requirements are dropped as soon as that is known, which keeps
+ * large combinatorics (e.g. six jets) manageable.\n\n
  * __Example:__\n
  * In your analysis file, do the following for the vector addition of two muons:
  *
@@ -82,6 +93,16 @@ namespace Algorithms
  *                                           2,
  *                                           "muons", "muons"));
  * ~~~~~~~~~~~~~~~~~~~~~~
+ * To only build neutral di-muons lighter than 150GeV:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ * HAL::Algorithms::VecAddReco *dimuons = new HAL::Algorithms::VecAddReco("di-muons", "neutral muon pairs", 
+ *                                                                       2,
+ *                                                                       "muons", "muons");
+ * dimuons->SetMaxMass(150000);
+ * dimuons->SetCharge(0);
+ * a.AddAlgo(dimuons);
+ * ~~~~~~~~~~~~~~~~~~~~~~
  */
 class VecAddReco : public Algorithm {
 public:
@@ -98,13 +119,66 @@ public:
   VecAddReco (TString name, TString title, long long length, ...);
   virtual ~VecAddReco();
 
+  //! Only keep tuples with an invariant mass of at most mass
+  /*!
+   * The mass of a sum of physical four-vectors never decreases as vectors 
+   * are added, so partial tuples are dropped as soon as they are too heavy.
+   */
+  void          SetMaxMass (double mass) {fMaxMass = mass;}
+  //! Only keep tuples whose charges add up to charge
+  /*!
+   * Partial tuples are dropped once the charges still available from the 
+   * remaining inputs can't reach charge.
+   */
+  void          SetCharge (double charge) {fHasCharge = true; fCharge = charge;}
+  //! Stop after count tuples (0 means no limit)
+  void          SetMaxCandidates (size_t count) {fMaxCandidates = count;}
+
 protected:
   virtual void  Exec (Option_t* /*option*/);
-  virtual void  Clear (Option_t* /*option*/);
+  virtual bool  Reads (const TString &name);
 
 private:
-  const char**  fParentNames;
-  long long     fLength;
+  // hashing and comparison of the masks of fNextMasks (referenced by position)
+  struct MaskHash {
+    MaskHash (const std::vector<unsigned long long> *masks, const size_t *width) : fMasks(masks), fWidth(width) {}
+    size_t operator() (size_t t) const;
+    const std::vector<unsigned long long> *fMasks;
+    const size_t                          *fWidth;
+  };
+  struct MaskEqual {
+    MaskEqual (const std::vector<unsigned long long> *masks, const size_t *width) : fMasks(masks), fWidth(width) {}
+    bool operator() (size_t a, size_t b) const;
+    const std::vector<unsigned long long> *fMasks;
+    const size_t                          *fWidth;
+  };
+
+  const char**          fParentNames;
+  long long             fLength;
+  std::vector<DataKey>  fParentKeys;
+  DataKey               fParentsKey;
+  double                fMaxMass; // negative if there is no ceiling
+  bool                  fHasCharge;
+  double                fCharge;
+  size_t                fMaxCandidates;
+
+  // per-event work space (kept to avoid reallocating every event)
+  size_t                                            fWidth;         // 64-bit words per mask
+  std::unordered_map<unsigned long long, unsigned>  fLeafIDs;       // identity (GetIdentity) -> constituent id
+  ParticlePtrs                                      fLeaves;        // constituent id -> particle
+  std::vector<unsigned>                             fInputLeaves;   // constituent ids of each input particle
+  std::vector<size_t>                               fInputLeafOffsets;
+  std::vector<unsigned long long>                   fInputMasks;    // mask of each input particle
+  std::vector<char>                                 fInputValid;    // false if a particle repeats a constituent
+  std::vector<double>                               fInputSums;     // px, py, pz, E of each input particle
+  std::vector<double>                               fInputCharges;
+  std::vector<double>                               fChargeLow, fChargeHigh; // charge range of the inputs after each one
+  std::vector<double>                               fSums, fNextSums; // px, py, pz, E of each tuple
+  std::vector<double>                               fCharges, fNextCharges;
+  std::vector<unsigned long long>                   fMasks, fNextMasks;
+  std::vector<long long>                            fLast, fNextLast; // index of the last particle taken
+  std::unordered_set<size_t, MaskHash, MaskEqual>   fUnique;
+  ParticlePtrs                                      fNewParents;
 };
 
 } /* Algorithms */ 
@@ -13,11 +13,28 @@
 #include <TNamed.h>
 #include <TString.h>
 #include <HAL/Common.h>
+#include <HAL/DenseIndexMap.h>
 #include <HAL/Exceptions.h>
+#include <HAL/StaticDataMap.h>
 
 namespace HAL
 {
 
+class AnalysisData;
+
+namespace internal
+{
+
+//! Source of a value that AnalysisData computes only when it is requested
+class ValueProvider {
+public:
+  virtual ~ValueProvider () {}
+  //! Store the value in data (called by the getters when the value is missing)
+  virtual void  Provide (AnalysisData *data) = 0;
+};
+
+} /* internal */
+
 //! Class for storage and sharing of data referenced by strings
 /*!
  * This class aids in passing data between algorithms.
@@ -25,7 +42,11 @@ namespace HAL
  * when algorithms must pass plain old data (POD) between
  * each other as a TList may only hold object deriving from
  * TObject. This class provides a way for POD to be stored
- * and retrieved by strings.
+ * and retrieved by strings. Every method taking a string name also
+ * has a version taking a DataKey, which skips the string lookup and
+ * indexes the storage directly. Single (non-indexed) values live in a
+ * StaticDataMap, so compiled algorithms can also grab a typed Handle
+ * once and read or write the value without any lookup at all.
  */
 class AnalysisData : public TNamed {
 
@@ -34,34 +55,77 @@ private:
                     kIB, kID, kII, kIC, kIS, kIO,
                     kIIB, kIID, kIII, kIIC, kIIS, kIIO};
 
-  std::map<std::string, StorageType, internal::string_cmp>  fNameTypeMap;
+  // Flat table indexed by DataKey id. Each slot remembers the storage type
+  // of the name and points at the value held in the corresponding map
+  // (std::map nodes never move, so the pointer stays valid until erased).
+  struct DataSlot {
+    DataSlot () : fType(kB), fRegistered(false), fValue(nullptr) {}
+    StorageType fType;
+    bool        fRegistered;
+    void       *fValue;
+  };
+
+  // sorted lexicographically so that all names under a prefix are adjacent
+  typedef std::map<std::string, StorageType>                NameTypeMap;
+  NameTypeMap                                               fNameTypeMap;
+  std::vector<DataSlot>                                     fSlots;
+
+  inline DataSlot& GetSlot (const DataKey &k) {
+    if (k.GetID() >= fSlots.size()) fSlots.resize(k.GetID() + 1);
+    return fSlots[k.GetID()];
+  }
+  inline DataSlot* FindSlot (const DataKey &k) {
+    if (!k.IsValid() || k.GetID() >= fSlots.size() || !fSlots[k.GetID()].fRegistered) return nullptr;
+    return &fSlots[k.GetID()];
+  }
+  // providers of values computed on demand, indexed by DataKey id
+  std::vector<internal::ValueProvider*>                     fProviders;
 
-  inline bool NameAlreadyStored (const std::string &n) {return fNameTypeMap.count(n) != 0 ? true : false;}
+  inline internal::ValueProvider* FindProvider (const DataKey &k) {
+    return (k.IsValid() && k.GetID() < fProviders.size()) ? fProviders[k.GetID()] : nullptr;
+  }
+  // slot of k after asking its provider (if any) for a missing value
+  inline DataSlot* ValueSlot (const DataKey &k) {
+    DataSlot *slot = FindSlot(k);
+    if (slot != nullptr && slot->fValue != nullptr) return slot;
+    internal::ValueProvider *provider = FindProvider(k);
+    if (provider == nullptr) return slot;
+    provider->Provide(this);
+    return FindSlot(k);
+  }
+  static unsigned StorageDim (StorageType);
+  void            RegisterName (const DataKey&, StorageType);
+  void            PrefixRange (const std::string &prefix, NameTypeMap::iterator &first, 
+                               NameTypeMap::iterator &last);
+  DataKey         RetrievalKey (const TString&);
+  template <class T>
+  bool            GetNumber (DataSlot*, const long long &i, const long long &j, T &value);
 
 protected:
-  std::map<std::string, bool, internal::string_cmp>                                 fBoolMap;
-  std::map<std::string, long double, internal::string_cmp>                          fDecimalMap;
-  std::map<std::string, long long, internal::string_cmp>                            fIntegerMap;
-  std::map<std::string, unsigned long long, internal::string_cmp>                   fCountingMap;
-  std::map<std::string, std::string, internal::string_cmp>                          fStringMap;
-  std::map<std::string, TObject*, internal::string_cmp>                             fTObjectMap;
+  // the order of the types must match the order in StorageType
+  typedef StaticDataMap<StaticDataMap_internal::value_t, bool, long double, long long, 
+                        unsigned long long, std::string, TObject*>         ScalarDataMap;
+
+  ScalarDataMap                                                                     fScalarMap; //!
   // the integer maps mimic the "index" of the element
-  // this allows for disjoint indices without wasted space
-  std::map<std::string, std::map<long long, bool>, internal::string_cmp >               fBoolIntMap;
-  std::map<std::string, std::map<long long, long double>, internal::string_cmp >        fDecimalIntMap;
-  std::map<std::string, std::map<long long, long long>, internal::string_cmp >          fIntegerIntMap;
-  std::map<std::string, std::map<long long, unsigned long long>, internal::string_cmp > fCountingIntMap;
-  std::map<std::string, std::map<long long, std::string>, internal::string_cmp >        fStringIntMap;
-  std::map<std::string, std::map<long long, TObject*>, internal::string_cmp >           fTObjectIntMap;
+  // contiguous indices are stored densely, disjoint ones fall back to a map
+  std::map<std::string, internal::DenseIndexMap<bool>, internal::string_cmp >               fBoolIntMap;
+  std::map<std::string, internal::DenseIndexMap<long double>, internal::string_cmp >        fDecimalIntMap;
+  std::map<std::string, internal::DenseIndexMap<long long>, internal::string_cmp >          fIntegerIntMap;
+  std::map<std::string, internal::DenseIndexMap<unsigned long long>, internal::string_cmp > fCountingIntMap;
+  std::map<std::string, internal::DenseIndexMap<std::string>, internal::string_cmp >        fStringIntMap;
+  std::map<std::string, internal::DenseIndexMap<TObject*>, internal::string_cmp >           fTObjectIntMap;
   // for 2D "indexing"
-  std::map<std::string, std::map<long long, std::map<long long, bool> >, internal::string_cmp >               fBoolIntIntMap;
-  std::map<std::string, std::map<long long, std::map<long long, long double> >, internal::string_cmp >        fDecimalIntIntMap;
-  std::map<std::string, std::map<long long, std::map<long long, long long> >, internal::string_cmp >          fIntegerIntIntMap;
-  std::map<std::string, std::map<long long, std::map<long long, unsigned long long> >, internal::string_cmp > fCountingIntIntMap;
-  std::map<std::string, std::map<long long, std::map<long long, std::string> >, internal::string_cmp >        fStringIntIntMap;
-  std::map<std::string, std::map<long long, std::map<long long, TObject*> >, internal::string_cmp >           fTObjectIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<bool> >, internal::string_cmp >               fBoolIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long double> >, internal::string_cmp >        fDecimalIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long long> >, internal::string_cmp >          fIntegerIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> >, internal::string_cmp > fCountingIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<std::string> >, internal::string_cmp >        fStringIntIntMap;
+  std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<TObject*> >, internal::string_cmp >           fTObjectIntIntMap;
 
 public:
+  template <class T> using Handle = ScalarDataMap::Handle<T>;
+
   virtual ~AnalysisData () {}
 
   // Bool values
@@ -139,6 +203,34 @@ public:
   // TObjects
   virtual void SetValue (const TString&, TObject*, const long long&, const long long&);
 
+  // Interned-key versions (the string versions above forward to these)
+  virtual void SetValue (const DataKey&, const bool&);
+  virtual void SetValue (const DataKey&, const long double&);
+  virtual void SetValue (const DataKey &k, const double &v) {SetValue(k, (long double)v);}
+  virtual void SetValue (const DataKey&, const long long&);
+  virtual void SetValue (const DataKey &k, const int &v) {SetValue(k, (long long)v);}
+  virtual void SetValue (const DataKey&, const unsigned long long&);
+  virtual void SetValue (const DataKey &k, const unsigned int &v) {SetValue(k, (unsigned long long)v);}
+  virtual void SetValue (const DataKey &k, const unsigned long &v) {SetValue(k, (unsigned long long)v);}
+  virtual void SetValue (const DataKey&, const std::string&);
+  virtual void SetValue (const DataKey&, TObject*);
+  virtual void SetValue (const DataKey&, const bool&, const long long&);
+  virtual void SetValue (const DataKey&, const long double&, const long long&);
+  virtual void SetValue (const DataKey &k, const double &v, const long long &i) {SetValue(k, (long double)v, i);}
+  virtual void SetValue (const DataKey&, const long long&, const long long&);
+  virtual void SetValue (const DataKey &k, const int &v, const long long &i) {SetValue(k, (long long)v, i);}
+  virtual void SetValue (const DataKey&, const unsigned long long&, const long long&);
+  virtual void SetValue (const DataKey &k, const unsigned int &v, const long long &i) {SetValue(k, (unsigned long long)v, i);}
+  virtual void SetValue (const DataKey &k, const unsigned long &v, const long long &i) {SetValue(k, (unsigned long long)v, i);}
+  virtual void SetValue (const DataKey&, const std::string&, const long long&);
+  virtual void SetValue (const DataKey&, TObject*, const long long&);
+  virtual void SetValue (const DataKey&, const bool&, const long long&, const long long&);
+  virtual void SetValue (const DataKey&, const long double&, const long long&, const long long&);
+  virtual void SetValue (const DataKey&, const long long&, const long long&, const long long&);
+  virtual void SetValue (const DataKey&, const unsigned long long&, const long long&, const long long&);
+  virtual void SetValue (const DataKey&, const std::string&, const long long&, const long long&);
+  virtual void SetValue (const DataKey&, TObject*, const long long&, const long long&);
+
   bool                GetBool (const TString&, const long long &i = -1, const long long &j = -1);
   long double         GetDecimal (const TString&, const long long &i = -1, const long long &j = -1);
   long long           GetInteger (const TString&, const long long &i = -1, const long long &j = -1);
@@ -146,10 +238,43 @@ public:
   TString             GetString (const TString&, const long long &i = -1, const long long &j = -1);
   TObject*            GetTObject (const TString&, const long long &i = -1, const long long &j = -1);
 
+  bool                GetBool (const DataKey&, const long long &i = -1, const long long &j = -1);
+  long double         GetDecimal (const DataKey&, const long long &i = -1, const long long &j = -1);
+  long long           GetInteger (const DataKey&, const long long &i = -1, const long long &j = -1);
+  unsigned long long  GetCounting (const DataKey&, const long long &i = -1, const long long &j = -1);
+  TString             GetString (const DataKey&, const long long &i = -1, const long long &j = -1);
+  TObject*            GetTObject (const DataKey&, const long long &i = -1, const long long &j = -1);
+
+  //! Typed handle to a single value
+  /*!
+   * Registers the name with type T (one of bool, long double, long long, 
+   * unsigned long long, std::string or TObject*) and returns a handle 
+   * that reads and writes the value directly. Values written through the
+   * handle are seen by the getters above. The handle should be acquired 
+   * again after RemoveData, RemoveNameAndData or Reset of the name.
+   */
+  template <class T>
+  Handle<T>                 GetHandle (const DataKey &key);
+  template <class T>
+  Handle<T>                 GetHandle (const TString &n) {return GetHandle<T>(DataKey(n));}
+
+  //! Compute the single value of key on demand
+  /*!
+   * Whenever key is requested while it holds no value, provider is asked to
+   * store it first. Providers are kept by Reset and the Remove methods, so
+   * removing the value makes the next request compute it again. A null
+   * provider unregisters the key.
+   */
+  void                      SetProvider (const DataKey &key, internal::ValueProvider *provider);
   bool                      Exists (const TString &n, const long long &i = -1, const long long &j = -1);
+  bool                      Exists (const DataKey &k, const long long &i = -1, const long long &j = -1);
   unsigned                  TypeDim (std::string n);
   unsigned                  TypeDim (const TString &n) {return TypeDim(std::string(n.Data()));}
   std::vector<TString>      GetSimilarNames (const TString &n, unsigned min_dim);
+  //! Number of registered names
+  size_t                    GetNNames () const {return fNameTypeMap.size();}
+  //! Number of registered names that currently hold a value
+  size_t                    GetNValues () const;
   // Copy value(s) stored in <map>[from] to <map>[to]
   void                      CopyValues (const TString &from, const TString &to);
   // Swap elements in a 1D or 2D IntMap or IntIntMap
@@ -157,135 +282,29 @@ public:
   void                      Reset ();
   void                      RemoveNameAndData (const TString&);
   void                      RemoveData (const TString&);
+  void                      RemoveData (const DataKey&);
   void                      RemoveAllAssociatedData (const TString&);
 
   ClassDef(AnalysisData, 0);
 
 };
 
-#ifndef __CLING__
-
-namespace StaticDataMap_internal {
-  // keep in case looping over DataMap needs specialization
-  template<typename FuncT, std::size_t I = 0, typename ... Tp>
-  void
-  for_each_DataMap (std::tuple<Tp ...> &t, FuncT &&f)
-  {
-    f(std::get<I>(t));
-    ::HAL::internal::for_each<FuncT, I + 1, Tp ...>(t, std::forward<FuncT>(f));
-  }
-
-  template<typename FuncT, std::size_t I = 0, typename ... Tp>
-  void
-  for_each_DataMap (std::tuple<Tp ...> &t, const FuncT &f)
-  {
-    f(std::get<I>(t));
-    ::HAL::internal::for_each<FuncT, I + 1, Tp ...>(t, f);
-  }
+template <class T>
+AnalysisData::Handle<T> AnalysisData::GetHandle (const DataKey &key)
+{
+  const StorageType type = StorageType(ScalarDataMap::type_index<T>());
+  DataSlot &slot = GetSlot(key);
 
-  template <class Type> using map = std::map<std::string, Type, ::HAL::internal::string_cmp>;
+  if (!slot.fRegistered)
+    RegisterName(key, type);
+  else if (slot.fType != type)
+    throw HALException(key.GetName().Prepend("Handle type does not match the storage container for "));
 
+  Handle<T> handle = fScalarMap.handle<T>(key);
+  slot.fValue = &*handle;
+  return handle;
 }
 
-
-
-// CRTP: Derived::TupleType_t<Types>
-//        Derived type needs to supply a TupleType_t template that takes one parameter (expanded from variatic Types...); this is the type that will be stored
-//        ex: for just storing single values of a given type - template <class T> using TupleType_t = T;
-//        ex: for storing tuples of values of a given type with a bool - template <class T> using TupleType_t = std::tuple<T, bool>;
-template<class Derived, class ... Types>
-class StaticDataMap {
-private:
-
-  // "type", map
-  std::tuple<StaticDataMap_internal::map<typename Derived::template TupleType_t<Types>>...> m_variableMaps;
-  unsigned long long m_count     = 0;
-
-public:
-  ClassDef(StaticDataMap, 0);
-
-  class StaticDataMap_Proxy {
-    StaticDataMap &m_map;
-    std::string    m_key;
-
-  public:
-
-    StaticDataMap_Proxy (StaticDataMap &map, const std::string &key) :
-      m_map(map), m_key(key) {}
-
-      template<class Ref>
-      operator Ref()
-      {
-        return m_map.get<Ref>(m_key);
-      }
-
-      template<class Ref>
-      StaticDataMap& operator=(const Ref &val)
-      {
-        m_map.set(m_key, val);
-        return m_map;
-      }
-    };
-
-  virtual ~StaticDataMap () {}
-
-  // basic things
-  template<class Ref>
-  auto access(const std::string & name)
-  {
-    return std::get<std::decay<Ref>::decay_t>(m_variableMaps)[name];
-  }
-
-  template<class Ref>
-  Ref get (const std::string &name)
-  {
-    if (!this->exists(name)) Fatal("StaticDataMap::get()" ,"key (%s) does not exist", name.c_str());
-    // return std::get<0>(this->access<Ref>(name));
-    return this->access<Ref>(name);
-  }
-
-  template<class Ref>
-  void get (const std::string &name, Ref &val)
-  {
-    val = this->get<Ref>(name);
-  }
-
-  template<class Ref>
-  void set (const std::string &name, const Ref &val)
-  {
-    // std::get<0>(this->access<Ref>(name)) = val;
-    this->access<Ref>(name) = val;
-  }
-
-  template<class Func>
-  void for_each (const Func &f)
-  {
-    StaticDataMap_internal::for_each_DataMap(m_variableMaps, f);
-  }
-
-  bool exists (const std::string &key)
-  {
-    auto result = false;
-    auto keyCheck = [&result, &key](const auto &t) {
-      if (result) return;
-      for (auto &p : t) {
-        result = result || (key == p.first);
-        if (result) break;
-      }
-    };
-    this->for_each(keyCheck);
-    return result;
-  } // exists
-
-  StaticDataMap_Proxy operator[] (const std::string &key)
-  {
-    return StaticDataMap_Proxy(*this, key);
-  }
-
-};
-
-#endif
-
 } /*  HAL */
 
 #endif
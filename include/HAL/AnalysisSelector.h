@@ -20,6 +20,7 @@ class TTree;
 namespace HAL
 {
 class Algorithm;
+class EventArena;
 }
 // end forward declaration(s)
 
@@ -33,6 +34,7 @@ private:
                   fOutputTreeName, 
                   fOutputTreeDescription;
   Algorithm      *fAnalysisFlow;
+  EventArena     *fEventArena;              //!event arena of fInput (reset after every entry)
   TTree          *fChain;                   //pointer to the analyzed TTree or TChain
   TMap           *fBranchMap;
 
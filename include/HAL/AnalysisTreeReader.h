@@ -153,6 +153,15 @@ public:
   TClonesArray&             GetClonesArray (const TString &branchname, const long long &idx_1 = -1);
   TRef&                     GetRef (const TString &branchname, const long long &idx_1 = -1, const long long &idx_2 = -1);
   TRefArray&                GetRefArray (const TString &branchname, const long long &idx_1 = -1);
+  //! Every value of a scalar or 1D branch in one call
+  /*!
+   * Sets n to the number of values and returns a pointer to them. Branches
+   * that are already stored with the requested type are returned in place,
+   * other numeric branches are converted into a buffer kept for the branch.
+   * The values are valid until the next entry is read.
+   */
+  const long double*        GetDecimalArray (const TString &branchname, size_t &n);
+  const long long*          GetIntegerArray (const TString &branchname, size_t &n);
 
   ClassDef(AnalysisTreeReader, 0);
 
@@ -178,6 +187,9 @@ public:
   void        SetEntry (Long64_t entry);
   AnalysisTreeReader::StorageType GetStorageType () {return fStorageID;}
   Int_t       GetStorageIndex () {return fStorageIndex;}
+  //! Conversion buffers for GetDecimalArray and GetIntegerArray
+  std::vector<long double>& GetDecimalBuffer () {return fDecimalBuffer;}
+  std::vector<long long>&   GetIntegerBuffer () {return fIntegerBuffer;}
 
 private:
   AnalysisTreeReader::StorageType            fStorageID; // this will be the proprietary type to use in the ATR
@@ -187,6 +199,8 @@ private:
   Int_t                  fLeafNdata;
   TBranch               *fBranch;
   AnalysisTreeReader    *fTreeReader;
+  std::vector<long double>  fDecimalBuffer;
+  std::vector<long long>    fIntegerBuffer;
 
   static const int       fMaxBufferLength = 10000;
   static const int       fMaxBufferLength2 = 100;
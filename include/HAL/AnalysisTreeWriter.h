@@ -8,6 +8,8 @@
 
 #include <map>
 #include <set>
+#include <vector>
+#include <TObject.h>
 #include <TString.h>
 #include <HAL/Common.h>
 #include <HAL/AnalysisData.h>
@@ -33,13 +35,17 @@ private:
                                                                 fTreeDescription;
   std::map<TString, TString, internal::string_cmp>              fBranchTreeMap;
   std::map<TString, std::set<long long>, internal::string_cmp>  fTreeIndicesMap;
+  std::vector<TObject*>                                         fObjects;
 
 public:
   AnalysisTreeWriter (const TString &ofile);
+  ~AnalysisTreeWriter ();
   inline void       SetTreeName (const TString &tname) {fTreeName = tname;}
   inline void       SetTreeDescription (const TString &tdescription) {fTreeDescription = tdescription;}
   inline void       SetTreeForBranch (const TString &tree, const TString &branch) {fBranchTreeMap[branch] = tree;}
   inline TString    GetTreeForBranch (const TString &branch) {return fBranchTreeMap[branch];}
+  //! Write obj (e.g. a histogram) to the output file next to the trees; the writer takes it over
+  void              AddObject (TObject *obj);
   //! \cond NODOC
   inline void       IncrementCount () {++fCount;}
   void              WriteData ();
@@ -58,6 +64,20 @@ public:
   // Counting values
   virtual void      SetValue (const TString &n, const unsigned long long &v);
   virtual void      SetValue (const TString &n, const unsigned long long &v, const long long &i);
+  // Interned-key versions
+  virtual void      SetValue (const DataKey &k, const bool &v);
+  virtual void      SetValue (const DataKey &k, const bool &v, const long long &i);
+  virtual void      SetValue (const DataKey &k, const long double &v);
+  virtual void      SetValue (const DataKey &k, const long double &v, const long long &i);
+  virtual void      SetValue (const DataKey &k, const long long &v);
+  virtual void      SetValue (const DataKey &k, const long long &v, const long long &i);
+  virtual void      SetValue (const DataKey &k, const unsigned long long &v);
+  virtual void      SetValue (const DataKey &k, const unsigned long long &v, const long long &i);
+
+private:
+  void              RecordEntry (const TString &n);
+
+public:
 
   ClassDefNV(AnalysisTreeWriter, 0);
 };
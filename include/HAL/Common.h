@@ -6,6 +6,8 @@
 #endif
 #include <cstring>
 #include <string>
+#include <deque>
+#include <vector>
 #include <tuple>
 #include <type_traits>
 #include <RVersion.h>
@@ -75,6 +77,83 @@ public:
   }
 };
 
+//! Process-wide table that interns names into dense integer ids
+/*!
+ * Names are hashed once (FNV-1a) into an open-addressing table with
+ * linear probing. Ids are handed out sequentially, so they can be used
+ * directly as indices into flat arrays (see AnalysisData).
+ */
+class SymbolTable {
+public:
+  static const unsigned kNoSymbol = 0xFFFFFFFF;
+
+  //! Return the id of name, adding it to the table if necessary
+  static unsigned           Intern (const char *name, unsigned length);
+  //! Return the id of name or kNoSymbol if it was never interned
+  static unsigned           Find (const char *name, unsigned length);
+  //! Return the name associated with an id
+  static const std::string& Name (unsigned id);
+  //! Number of interned names
+  static unsigned           Size ();
+
+private:
+  SymbolTable ();
+  static SymbolTable& Instance ();
+
+  unsigned  Lookup (const char *name, unsigned length, bool insert);
+  void      Rehash (unsigned nbuckets);
+
+  std::vector<unsigned>           fBuckets; // id + 1 (0 marks an empty bucket)
+  std::vector<unsigned long long> fHashes;  // hash of each interned name
+  std::deque<std::string>         fNames;   // deque keeps references stable
+};
+
+} /* internal */
+
+//! Interned name used for fast lookups in AnalysisData
+/*!
+ * Constructing a DataKey interns the name once so that later lookups
+ * through the key are a single array access instead of a tree walk with
+ * string comparisons. Algorithms should build their keys at construction
+ * time and use them in Exec.
+ */
+class DataKey {
+public:
+  DataKey () : fID(internal::SymbolTable::kNoSymbol) {}
+  explicit DataKey (const TString &name) :
+    fID(internal::SymbolTable::Intern(name.Data(), name.Length())) {}
+  explicit DataKey (const char *name) :
+    fID(internal::SymbolTable::Intern(name, strlen(name))) {}
+  explicit DataKey (const std::string &name) :
+    fID(internal::SymbolTable::Intern(name.c_str(), name.size())) {}
+
+  //! Key of a previously interned name (invalid if it was never interned)
+  static DataKey            Find (const TString &name) {
+    DataKey key;
+    key.fID = internal::SymbolTable::Find(name.Data(), name.Length());
+    return key;
+  }
+  static DataKey            Find (const std::string &name) {
+    DataKey key;
+    key.fID = internal::SymbolTable::Find(name.c_str(), name.size());
+    return key;
+  }
+
+  unsigned                  GetID () const {return fID;}
+  bool                      IsValid () const {return fID != internal::SymbolTable::kNoSymbol;}
+  const std::string&        GetString () const {return internal::SymbolTable::Name(fID);}
+  TString                   GetName () const {return IsValid() ? TString(GetString().c_str()) : TString("");}
+
+  bool operator== (const DataKey &other) const {return fID == other.fID;}
+  bool operator!= (const DataKey &other) const {return fID != other.fID;}
+
+private:
+  unsigned fID; //! ids are only meaningful within the current process
+};
+
+namespace internal
+{
+
 // ---------------------------------------------
 // tuple for_each (iterate over an std::tuple))
 // ---------------------------------------------
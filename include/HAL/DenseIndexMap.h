@@ -0,0 +1,156 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_DenseIndexMap
+#define HAL_DenseIndexMap
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+//! Index -> value container optimized for contiguous indices
+/*!
+ * Non-negative indices close to the ones already stored (particle indices
+ * 0..n-1, event numbers 1..N, ...) live in a flat vector, so filling,
+ * iterating and copying touch contiguous memory and do not allocate per
+ * element. Negative or far away indices fall back to a std::map. Entries in
+ * the map always lie outside the range covered by the vector, and they are
+ * moved into the vector when it grows over them, so every index is stored
+ * in exactly one place. The interface mirrors the parts of std::map that
+ * AnalysisData uses.
+ */
+template <class T>
+class DenseIndexMap {
+public:
+  DenseIndexMap () : fSize(0) {}
+
+  //! Value at index i (default constructed and inserted if absent)
+  T&        operator[] (long long i)
+  {
+    if (i >= 0 && (size_t)i < fDense.size()) {
+      Cell &cell = fDense[i];
+      if (!cell.fSet) {
+        cell.fSet = true;
+        ++fSize;
+      }
+      return cell.fValue;
+    }
+    if (i >= 0 && (size_t)i < DenseLimit()) {
+      Grow(i + 1);
+      return (*this)[i];
+    }
+    typename std::map<long long, T>::iterator it = fSparse.find(i);
+    if (it == fSparse.end()) {
+      it = fSparse.insert(std::make_pair(i, T())).first;
+      ++fSize;
+    }
+    return it->second;
+  }
+
+  //! Pointer to the value at index i or nullptr if absent
+  T*        find (long long i)
+  {
+    if (i >= 0 && (size_t)i < fDense.size())
+      return fDense[i].fSet ? &fDense[i].fValue : nullptr;
+    typename std::map<long long, T>::iterator it = fSparse.find(i);
+    return it == fSparse.end() ? nullptr : &it->second;
+  }
+
+  const T*  find (long long i) const {return const_cast<DenseIndexMap*>(this)->find(i);}
+  size_t    count (long long i) const {return find(i) != nullptr ? 1 : 0;}
+  size_t    size () const {return fSize;}
+  bool      empty () const {return fSize == 0;}
+  //! True if no index needed the sparse fallback
+  bool      is_dense () const {return fSparse.empty();}
+
+  //! Remove every value (the dense capacity is kept for reuse)
+  void      clear ()
+  {
+    fDense.clear();
+    fSparse.clear();
+    fSize = 0;
+  }
+
+  void      swap (DenseIndexMap &other)
+  {
+    fDense.swap(other.fDense);
+    fSparse.swap(other.fSparse);
+    std::swap(fSize, other.fSize);
+  }
+
+  //! Call f(index, value) for every value in ascending index order
+  template <class Func>
+  void      for_each (Func &f) const
+  {
+    typename std::map<long long, T>::const_iterator it = fSparse.begin();
+
+    for (; it != fSparse.end() && it->first < 0; ++it)
+      f(it->first, it->second);
+    for (size_t i = 0; i < fDense.size(); ++i) {
+      if (fDense[i].fSet)
+        f((long long)i, fDense[i].fValue);
+    }
+    for (; it != fSparse.end(); ++it)
+      f(it->first, it->second);
+  }
+
+  //! Append all values to out in ascending index order
+  template <class U>
+  void      values (std::vector<U> &out) const
+  {
+    Appender<U> append(out);
+    out.reserve(out.size() + fSize);
+    for_each(append);
+  }
+
+private:
+  struct Cell {
+    Cell () : fValue(), fSet(false) {}
+    T     fValue;
+    bool  fSet;
+  };
+
+  template <class U>
+  struct Appender {
+    explicit Appender (std::vector<U> &out) : fOut(out) {}
+    void operator() (long long, const T &value) {fOut.push_back(value);}
+    std::vector<U> &fOut;
+  };
+
+  // indices below this are considered contiguous with the dense range
+  size_t    DenseLimit () const {return 2 * fDense.size() + 64;}
+
+  void      Grow (size_t n)
+  {
+    size_t old_size = fDense.size();
+
+    fDense.resize(n < 2 * old_size ? 2 * old_size : n);
+    // pull sparse entries that are now covered by the dense range
+    typename std::map<long long, T>::iterator it = fSparse.lower_bound(old_size);
+    while (it != fSparse.end() && (size_t)it->first < fDense.size()) {
+      Cell &cell = fDense[it->first];
+      std::swap(cell.fValue, it->second);
+      cell.fSet = true;
+      fSparse.erase(it++);
+    }
+  }
+
+  std::vector<Cell>         fDense;
+  std::map<long long, T>    fSparse;
+  size_t                    fSize;
+};
+
+} /* internal */
+
+} /* HAL */
+
+#endif
@@ -0,0 +1,59 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_EtaPhiGrid
+#define HAL_EtaPhiGrid
+
+#include <cstddef>
+#include <vector>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+//! Eta-phi binned index of a set of points for fixed radius neighbour searches
+/*!
+ * The points are sorted into rectangular cells that are at least as wide as
+ * the search radius in both eta and phi, with phi cells wrapping around at
+ * \f$ \pm\pi \f$. Every point that lies within the radius of a query is in
+ * the query's cell or one of the eight cells around it, so Neighbours only
+ * has to return those. Points that are farther away may still be returned;
+ * the caller does the exact distance test. The number of cells is bounded by
+ * the number of points, so sparse or widely spread events do not allocate
+ * large empty grids. Points with a non-finite coordinate are returned for
+ * every query, and a query with a non-finite coordinate returns every point.
+ */
+class EtaPhiGrid {
+public:
+  EtaPhiGrid () : fNPoints(0), fNEta(0), fNPhi(0), fEtaMin(0.0), fEtaCell(0.0), fPhiCell(0.0) {}
+
+  //! Index n points (eta[i], phi[i]) for searches within radius (radius must be > 0)
+  void      Build (const double *eta, const double *phi, size_t n, double radius);
+  //! Replace candidates with the indices of the points that may lie within the radius
+  void      Neighbours (double eta, double phi, std::vector<size_t> &candidates) const;
+
+  size_t    GetNPoints () const {return fNPoints;}
+  size_t    GetNCells () const {return fNEta * fNPhi;}
+
+private:
+  long      EtaCell (double eta) const;
+  long      PhiCell (double phi) const;
+
+  size_t                fNPoints;
+  long                  fNEta, fNPhi;
+  double                fEtaMin, fEtaCell, fPhiCell;
+  std::vector<size_t>   fCellStart; // offsets into fEntries (one per cell plus one)
+  std::vector<size_t>   fEntries;   // point indices ordered by cell
+  std::vector<size_t>   fUnbinned;  // points with a non-finite coordinate
+  std::vector<long>     fCell;      // cell of each point (work buffer)
+};
+
+} /* internal */
+
+} /* HAL */
+
+#endif
@@ -0,0 +1,132 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_EventArena
+#define HAL_EventArena
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+#include <TNamed.h>
+#include <HAL/Common.h>
+#include <HAL/GenericParticle.h>
+#include <HAL/ObjectPool.h>
+
+// forward declaration(s)
+class TLorentzVector;
+// end forward declaration(s)
+
+namespace HAL
+{
+
+//! Bump allocator for objects that only live for one event
+/*!
+ * Objects created with New are carved out of large memory blocks that are
+ * kept for the whole job. At the end of every event the AnalysisSelector
+ * calls Reset, which runs the pending destructors and rewinds the blocks in
+ * one step, so the per-event cost of allocating particles, four-vectors and
+ * data containers no longer goes through the heap. Particles and
+ * four-vectors come from object pools owned by the arena instead: they are
+ * handed back on Reset but stay constructed, so the next event reuses them
+ * without running constructors again. Objects built in the arena or taken
+ * from its pools must never be deleted; owners should test pointers with
+ * Contains before deleting them.
+ */
+class EventArena : public TNamed {
+public:
+  //! Constructor
+  /*!
+   * \param[in] block_size Size in bytes of each block requested from the heap.
+   */
+  EventArena (size_t block_size = 65536);
+  virtual ~EventArena ();
+
+  //! Reserve raw memory that stays valid until the next Reset
+  void*   Allocate (size_t size, size_t alignment = alignof(long double));
+
+  //! Construct an object in the arena
+  /*!
+   * The object's destructor is run on Reset (if it is not trivial).
+   */
+  template <class T, class ... Args>
+  T*      New (Args&& ... args);
+
+  //! Particle from the particle pool (in a freshly constructed state)
+  ParticlePtr     NewParticle (const TString &owner, const TString &origin = "", const TString &name = "");
+  //! Copy of particle, including its four-vector, taken from the pools
+  ParticlePtr     CopyParticle (const GenericParticle &particle);
+  //! Zero four-vector from the four-vector pool
+  TLorentzVector* NewVector ();
+  //! Four-vector (px, py, pz, E) from the four-vector pool
+  TLorentzVector* NewVector (double px, double py, double pz, double e);
+
+  //! Destroy every object and make all memory (and pooled objects) available again
+  void    Reset ();
+
+  //! Returns true if ptr points into the memory of any live arena
+  /*!
+   * The blocks and pool chunks of every arena are kept sorted by address, so
+   * this is a binary search. Ownership follows the memory, not the object: a
+   * copy of a pooled object made elsewhere is never taken for an arena object.
+   */
+  static bool   Contains (const void *ptr);
+
+  size_t  GetNBlocks () const {return fBlocks.size();}
+  size_t  GetBytesInUse () const;
+  size_t  GetBytesReserved () const;
+  size_t  GetHighWaterMark () const {return fHighWaterMark;}
+  size_t  GetNPooledParticles () const {return fParticlePool.GetSize();}
+  size_t  GetNPooledVectors () const {return fVectorPool.GetSize();}
+
+  //! Print the memory and pool usage of the job
+  virtual void  Print (Option_t *option = "") const;
+
+private:
+  struct Block {
+    char   *fData;
+    size_t  fSize;
+  };
+  typedef void (*Destructor) (void*);
+
+  template <class T>
+  static void   Destroy (void *ptr) {static_cast<T*>(ptr)->~T();}
+  // make chunks the pool allocated since the last call known to Contains
+  template <class T>
+  static void   RegisterChunks (const internal::ObjectPool<T> &pool, size_t &nregistered);
+  template <class T>
+  static void   UnregisterChunks (const internal::ObjectPool<T> &pool);
+
+  size_t                                    fBlockSize;
+  size_t                                    fCurrent;       // index of the block being filled
+  size_t                                    fOffset;        // first free byte in the current block
+  size_t                                    fHighWaterMark;
+  std::vector<Block>                        fBlocks;
+  std::vector<std::pair<Destructor, void*> > fDestructors;
+  internal::ObjectPool<GenericParticle>     fParticlePool;
+  internal::ObjectPool<TLorentzVector>      fVectorPool;
+  size_t                                    fNParticleChunks; // chunks of the pools known to Contains
+  size_t                                    fNVectorChunks;
+
+  EventArena (const EventArena&);
+  EventArena& operator= (const EventArena&);
+
+  ClassDef(EventArena, 0);
+};
+
+template <class T, class ... Args>
+T* EventArena::New (Args&& ... args)
+{
+  void *memory = Allocate(sizeof(T), alignof(T));
+  T *object = ::new (memory) T(std::forward<Args>(args)...);
+  if (!std::is_trivially_destructible<T>::value)
+    fDestructors.push_back(std::make_pair(&EventArena::Destroy<T>, memory));
+  return object;
+}
+
+} /* HAL */
+
+#endif
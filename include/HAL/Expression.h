@@ -0,0 +1,137 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_Expression
+#define HAL_Expression
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <TString.h>
+#include <HAL/Common.h>
+#include <HAL/GenericParticle.h>
+
+namespace HAL
+{
+
+class AnalysisData;
+class ParticleCollection;
+
+namespace internal
+{
+
+//! Selection expression compiled to a small stack machine
+/*!
+ * The text is parsed once by Compile into a list of instructions that
+ * operate on whole columns: every instruction reads or combines one value
+ * per particle, so a collection is selected in a single pass with one tight
+ * loop per instruction. Comparisons and logical operators yield 1 or 0 and
+ * both sides of && and || are always evaluated.
+ *
+ * _Grammar (lowest to highest precedence):_
+ * | Operators | Meaning |
+ * | :-------- | :------ |
+ * | a \|\| b | logical or |
+ * | a && b | logical and |
+ * | == != < > <= >= and x in {v1, v2, ...} | comparisons and list membership |
+ * | + - | sum and difference |
+ * | * / | product and quotient |
+ * | -x !x | negation |
+ * | \|x\| abs(x) (x) | absolute value and grouping |
+ *
+ * _Terms:_
+ * | Term | Value |
+ * | :--- | :---- |
+ * | pt eta phi m e et p3 rapidity | kinematics of the particle |
+ * | id charge | id and charge of the particle |
+ * | any other name | attribute of the particle (see AttachAttribute) |
+ * | count(name) | number of particles in algorithm name (0 if it has no output) |
+ * | mindr(name) | smallest \f$ \Delta R \f$ between the particle and a different particle of algorithm name |
+ * | value(name) | number stored by algorithm name (see ImportValue) |
+ *
+ * Names inside count, mindr and value may be quoted ("muons pT") when they
+ * contain spaces or operators. Property names are case insensitive.
+ */
+class Expression {
+public:
+  Expression () : fDepth(0), fParticleLevel(false) {}
+
+  //! Parse text (throws HALException with the position of a syntax error)
+  void      Compile (const TString &text);
+  //! True if the expression uses properties of individual particles
+  bool      IsParticleLevel () const {return fParticleLevel;}
+  const TString& GetText () const {return fText;}
+
+  //! Evaluate the expression for every particle of particles
+  /*!
+   * keep[i] is set to 1 where the expression is non-zero. Returns false
+   * (with nothing kept) if a referenced value does not exist for this event.
+   */
+  bool      Evaluate (AnalysisData *data, const ParticleCollection &particles,
+                      std::vector<char> &keep);
+  //! Evaluate an expression without particle properties (false if a value is missing)
+  bool      Evaluate (AnalysisData *data);
+
+private:
+  enum OpCode {kConstant, kKinematic, kID, kCharge, kAttribute, kCount, kMinDeltaR, kValue,
+               kNegate, kNot, kAbs, kAdd, kSubtract, kMultiply, kDivide,
+               kEqual, kNotEqual, kLess, kGreater, kLessEqual, kGreaterEqual,
+               kAnd, kOr, kInList};
+  struct Instruction {
+    Instruction (OpCode code, size_t arg = 0, double value = 0.0) :
+      fCode(code), fArg(arg), fValue(value) {}
+    OpCode  fCode;
+    size_t  fArg; // kinematic, key or list index
+    double  fValue; // constant
+  };
+  enum TokenType {kEnd, kNumber, kName, kString, kSymbol};
+
+  // parser (recursive descent, emits postfix code)
+  void      Next ();
+  bool      Accept (const char *symbol);
+  void      Expect (const char *symbol);
+  void      Fail (const char *message) {Fail(message, fTokenStart);}
+  void      Fail (const char *message, size_t position);
+  void      ParseOr ();
+  void      ParseAnd ();
+  void      ParseComparison ();
+  void      ParseSum ();
+  void      ParseProduct ();
+  void      ParseUnary ();
+  void      ParsePrimary ();
+  // name started at position start of the text
+  void      ParseTerm (const std::string &name, size_t start);
+  size_t    ParseReference ();
+  void      Emit (OpCode code, size_t arg = 0, double value = 0.0);
+
+  bool      Run (AnalysisData *data, const ParticleCollection *particles, size_t n);
+  bool      Load (const Instruction &instr, AnalysisData *data,
+                  const ParticleCollection *particles, size_t n, double *out);
+
+  TString                             fText;
+  std::vector<Instruction>            fCode;
+  std::vector<DataKey>                fKeys;
+  std::vector<std::vector<double> >   fLists; // sorted
+  size_t                              fDepth;
+  bool                                fParticleLevel;
+
+  // parser state
+  std::string                         fSource;
+  size_t                              fPos, fTokenStart;
+  TokenType                           fToken;
+  std::string                         fTokenText;
+  double                              fTokenValue;
+  size_t                              fStackSize;
+
+  // evaluation buffers (reused between events)
+  std::vector<std::vector<double> >   fStack;
+  std::vector<long double>            fAttributeValues;
+};
+
+} /* internal */
+
+} /* HAL */
+
+#endif
@@ -6,12 +6,15 @@
 #ifndef HAL_GenericData
 #define HAL_GenericData
 
+#include <deque>
 #include <map>
+#include <set>
 #include <iostream>
 #include <TNamed.h>
 #include <TString.h>
 #include <HAL/Common.h>
 #include <HAL/GenericParticle.h>
+#include <HAL/ParticleCollection.h>
 
 namespace HAL
 {
@@ -22,37 +25,185 @@ namespace HAL
 
 class GenericData : public TNamed {
 private:
+  // one attribute for every particle owned by this container (fOverlay is
+  // the container that attached the values, nullptr for the particles' own)
+  struct AttributeColumn {
+    DataKey                   fKey;
+    const GenericData        *fOverlay;
+    std::vector<long double>  fValues;
+    std::vector<char>         fSet;
+  };
+
   bool                                                  fIsOwner;
   // used if value is stored in 'UserData' (i.e. a trigger boolean)
   TString                                               fUserDataRefName, fUserDataRefType; 
+  // interned fUserDataRefName (invalid until it is first needed)
+  DataKey                                               fUserDataRefKey; //!
   // list of actual particles (and actual owner of memory)
   ParticlePtrs                                          fParticles;
   // the following is for sorted lists, etc...
   std::map<TString, ParticlePtrs, internal::string_cmp> f1DParticles;
+  // columnar copy of fParticles (rebuilt lazily after particles are added or changed)
+  ParticleCollection                                    fCollection; //!
+  bool                                                  fCollectionValid;
+  // bumped whenever fCollection is rebuilt, so selections from it know to rebuild too
+  size_t                                                fCollectionGeneration; //!
+  // generation of fSource's collection that fCollection was gathered from
+  size_t                                                fSourceGeneration; //!
+  // attributes of the owned particles (indexed by particle position)
+  std::vector<AttributeColumn>                          fAttributes;
+  // permutations of fParticles sorted by a kinematic (see GetSortedIndices)
+  struct SortedIndices {
+    GenericParticle::Kinematic  fProperty;
+    bool                        fDescending;
+    std::vector<size_t>         fIndices;
+  };
+
+  // a deque, so the lists already handed out stay in place as more are added
+  std::deque<SortedIndices>                             fSorted; //!
+  // container this one was selected from (its attribute overlays are inherited)
+  GenericData                                          *fSource; //!
+  // position in fSource of every particle (if all were added with AddSelected)
+  std::vector<size_t>                                   fSourceIndices; //!
+
+  void          Adopt (ParticlePtr particle);
+  bool          LookupAttribute (ParticlePtr particle, const DataKey &key, long double &value);
 
 public:
   GenericData (const TString &name, bool is_owner = false);
   GenericData (const GenericData &data);
   virtual ~GenericData ();
 
-  void          SetRefName (const TString &name) {fUserDataRefName = name;}
+  //! Remove every particle, attribute and particle array for reuse in the next event
+  /*!
+   * The capacity of the internal lists is kept, so algorithms can hold one
+   * container for the whole job instead of creating one per event.
+   */
+  void          Reset ();
+
+  void          SetRefName (const TString &name) {fUserDataRefName = name; fUserDataRefKey = DataKey();}
+  void          SetRefName (const TString &name, const DataKey &key) {fUserDataRefName = name; fUserDataRefKey = key;}
   void          SetRefType (const TString &type) {fUserDataRefType = type;}
-  void          AddParticle (ParticlePtr particle) {fParticles.push_back(particle);}
+  void          SetSource (GenericData *source) {fSource = source;}
+  void          AddParticle (ParticlePtr particle) {
+    fParticles.push_back(particle);
+    fCollectionValid = false;
+    fSorted.clear();
+    if (fIsOwner) Adopt(particle);
+  }
+  //! Add the particle at position index of the source container
+  /*!
+   * A container filled only through AddSelected is an index list over its
+   * source, so its columnar view is gathered from the source's columns
+   * instead of being rebuilt from the particles.
+   */
+  void          AddSelected (size_t index) {
+    fParticles.push_back(fSource->fParticles[index]);
+    fSourceIndices.push_back(index);
+    fCollectionValid = false;
+    fSorted.clear();
+  }
   void          SetParticles (const TString &name, ParticlePtrs &particles) {f1DParticles[name] = particles;}
   inline TString        GetRefName () {return fUserDataRefName;}
+  //! Key of the referenced name, for reading the value without a string lookup
+  const DataKey&        GetRefKey () {
+    if (!fUserDataRefKey.IsValid() && fUserDataRefName.Length() > 0)
+      fUserDataRefKey = DataKey(fUserDataRefName);
+    return fUserDataRefKey;
+  }
   inline TString        GetRefType () {return fUserDataRefType;}
   inline ParticlePtr    GetParticle (const long long &index) {return fParticles[index];}
   inline ParticlePtrsIt GetParticleBegin () {return fParticles.begin();}
   inline ParticlePtrsIt GetParticleEnd () {return fParticles.end();}
   inline ParticlePtrs&  GetParticles (const TString &name) {return f1DParticles[name];}
+  //! Columnar view of the particles (see ParticleCollection)
+  ParticleCollection&   GetCollection ();
+  //! Mark the columnar view and sorted orders as out of date
+  /*!
+   * The setters of GenericParticle call this for the particle's owner, and
+   * selections made from a container notice that it was rebuilt. A container
+   * that only references particles it neither owns nor selected (AddParticle
+   * without ownership) must be invalidated by hand after its particles change.
+   */
+  void                  InvalidateCollection () {fCollectionValid = false; fSorted.clear();}
+  //! Positions of the particles ordered by property
+  /*!
+   * The order is stable (ties keep their position in this container). The
+   * permutation is computed once and then shared by every rank based
+   * algorithm of the event that asks for the same property and direction.
+   */
+  const std::vector<size_t>& GetSortedIndices (GenericParticle::Kinematic property, bool descending);
 
   inline bool       IsOwner () {return fIsOwner;}
+  inline GenericData* GetSource () {return fSource;}
+  //! True if every particle was added with AddSelected
+  inline bool       IsSelection () const {
+    return fSource != nullptr && !fIsOwner && fSourceIndices.size() == fParticles.size();
+  }
+  inline size_t     GetSourceIndex (size_t i) const {return fSourceIndices[i];}
   inline TString    GetOwner () {return (fParticles.size() >= 1) ? fParticles[0]->GetOwner() : "";}
   inline TString    GetOrigin () {return (fParticles.size() >= 1) ? fParticles[0]->GetOrigin() : "";}
   inline bool       HasParticles (const TString &name) {return (f1DParticles.count(name) != 0) ? true : false;}
   inline size_t     GetNParticles () {return fParticles.size();}
   inline size_t     GetNParticles (const TString &name) {return HasParticles(name) ? f1DParticles[name].size() : 0;}
 
+  //! Attribute columns
+  /*!
+   * Attributes of the particles owned by this container are stored as one
+   * column per attribute name, registered once and then addressed by an
+   * integer column id and the particle's position in this container.
+   * GenericParticle's attribute methods forward here.
+   *
+   * A container that only references particles can also attach overlay
+   * values (see SetAttribute(ParticlePtr, ...)), so attributes can be added
+   * to a selection without copying particles. The values are kept in an
+   * overlay column of the particles' owner, tagged with the container that
+   * attached them. Through a container, only its own overlays and those of
+   * the containers it was selected from are visible (see SetSource), and
+   * algorithms read attributes through the container they work on. Overlays
+   * of one name on the same particles must come from containers selected
+   * from one another; RegisterAttribute throws if two unrelated containers
+   * attach the same name. The particle's own GetAttribute therefore sees the
+   * innermost overlay of that chain, like a copied particle carrying the
+   * value would.
+   */
+  unsigned          RegisterAttribute (const DataKey &key, const GenericData *overlay = nullptr);
+  //! Column id of key (attached by overlay, or the particles' own) or -1 if there is none
+  inline int        FindAttribute (const DataKey &key, const GenericData *overlay = nullptr) const {
+    for (size_t c = 0; c < fAttributes.size(); ++c)
+      if (fAttributes[c].fKey == key && fAttributes[c].fOverlay == overlay) return c;
+    return -1;
+  }
+  inline size_t         GetNAttributes () const {return fAttributes.size();}
+  inline const DataKey& GetAttributeKey (unsigned column) const {return fAttributes[column].fKey;}
+  inline const GenericData* GetAttributeOverlay (unsigned column) const {return fAttributes[column].fOverlay;}
+  inline bool           HasAttribute (unsigned column, size_t row) const {
+    return row < fAttributes[column].fSet.size() && fAttributes[column].fSet[row];
+  }
+  inline long double    GetAttribute (unsigned column, size_t row) const {
+    return HasAttribute(column, row) ? fAttributes[column].fValues[row] : 0.0;
+  }
+  //! Attribute of the particle at row as seen by the particle (innermost overlay first)
+  bool              FindParticleAttribute (size_t row, const DataKey &key, long double &value) const;
+  void              SetAttribute (unsigned column, size_t row, const long double &value);
+
+  //! Attribute of particle as seen through this container
+  /*!
+   * Overlays of this container win over those of its sources, which win
+   * over the attributes stored in the particle's owner.
+   */
+  bool              HasAttribute (ParticlePtr particle, const DataKey &key);
+  long double       GetAttribute (ParticlePtr particle, const DataKey &key);
+  //! Attach an attribute to particle in this container only
+  void              SetAttribute (ParticlePtr particle, const DataKey &key, const long double &value);
+  //! Names of every attribute of particle visible through this container
+  void              GetAttributeNames (ParticlePtr particle, std::set<TString> &names);
+  //! Fill values with attribute key of every particle (0 where it is missing)
+  /*!
+   * Returns false if any particle lacks the attribute.
+   */
+  bool              GatherAttribute (const DataKey &key, std::vector<long double> &values);
+
   friend std::ostream& operator<<(std::ostream& os, GenericData &data);
 
   ClassDef(GenericData, 0);
@@ -20,6 +20,7 @@ namespace HAL
  * */
 
 class GenericParticle;
+class GenericData;
 
 typedef GenericParticle               Particle;
 typedef Particle*                     ParticlePtr;
@@ -28,51 +29,154 @@ typedef ParticlePtrs::iterator        ParticlePtrsIt;
 typedef ParticlePtrs::const_iterator  ParticlePtrsConstIt;
 
 class GenericParticle : public TNamed {
+public:
+  //! Quantities of the four-vector that are cached on the particle
+  enum Kinematic {kPt, kEta, kPhi, kM, kE, kEt, kP3, kRapidity, kNKinematics};
+
 private:
+  //! Named list of related particles (parents, children, ...)
+  /*!
+   * Members are also kept as a sorted list of (origin, origin index) keys
+   * and a 64-bit mask with bit (origin index % 64) set for every member.
+   * When all members come from one origin with indices below 64 the mask
+   * identifies the set exactly, so sameness and overlap tests against a
+   * relation with the same origin are single bitwise operations. Otherwise
+   * the mask still rejects most mismatches before the keys are compared.
+   */
+  struct Relation {
+    DataKey                         fName;
+    ParticlePtrs                    fParticles; // in insertion order
+    std::vector<unsigned long long> fKeys;      // origin id << 32 | origin index, sorted
+    unsigned long long              fMask;
+    unsigned                        fOrigin;    // common origin id (kNoSymbol if mixed)
+    bool                            fExact;     // fMask alone identifies the members
+    bool                            fDirty;     // fParticles was handed out for changes
+
+    Relation () : fMask(0), fOrigin(internal::SymbolTable::kNoSymbol), fExact(true), fDirty(false) {}
+    void  Add (GenericParticle *particle);
+    void  Rebuild ();
+  };
+
   TString                                      fOwner; // what algorithm made this particle
   TString                                      fOrigin; // what algorithm first made this particle
   size_t                                       fOwnerIndex, fOriginIndex;
+  bool                                         fHasOriginIndex; // false until SetOriginIndex is called
   int                                          fID;
   float                                        fCharge;
   TLorentzVector                              *fP;
+  // lazily computed kinematics of fP (bit k of fCached marks fKinematics[k] as valid)
+  double                                       fKinematics[kNKinematics]; //!
+  unsigned                                     fCached; //!
+  // attributes live in a column of the GenericData that owns this particle
+  GenericData                                 *fAttributeData;
+  size_t                                       fAttributeRow;
+  // attributes of a particle without an owner (moved to the owner when it is added to one);
+  // for an owned particle, the copy last returned by GetAttributes
   std::map<TString, long double, internal::string_cmp>    fScalarAttributes;
+  DataKey                                      fOriginKey; //! interned fOrigin (set on first use)
   // the following is for parent/child lists etc...
-  std::map<TString, ParticlePtrs, internal::string_cmp>   f1DParticles;
+  std::vector<Relation>                        fRelations; //!
+
+  Relation*       FindRelation (const DataKey &name);
+  Relation&       AccessRelation (const DataKey &name);
+  // relation with its keys and mask brought up to date
+  Relation*       FindSyncedRelation (const DataKey &name);
 
 public:
   GenericParticle (const TString &owner, const TString &origin = "", const TString &name = "");
   GenericParticle (const GenericParticle &particle);
   ~GenericParticle ();
 
+  //! Put the particle back into its freshly constructed state (for reuse by a pool)
+  void            Reset (const TString &owner, const TString &origin = "", const TString &name = "");
+  //! Copy everything from particle, storing its four-vector in vec
+  void            Assign (const GenericParticle &particle, TLorentzVector *vec);
+
   void            SetOwner (const TString &owner) {fOwner = owner;}
-  void            SetOrigin (const TString &origin) {fOrigin = origin;}
+  void            SetOrigin (const TString &origin) {fOrigin = origin; fOriginKey = DataKey();}
   void            SetOwnerIndex (const size_t &oi) {fOwnerIndex = oi;}
-  void            SetOriginIndex (const size_t &oi) {fOriginIndex = oi;}
-  void            SetID (const int &id) {fID = id;}
-  void            SetCharge (const float &charge) {fCharge = charge;}
-  void            SetP (TLorentzVector *p) {fP = p;}
-  void            SetVector (TLorentzVector *vec) {fP = vec;}
+  // the setters below also invalidate the owner's columnar view (see ParticleCollection)
+  void            SetOriginIndex (const size_t &oi) {fOriginIndex = oi; fHasOriginIndex = true; NotifyOwner();}
+  void            SetID (const int &id) {fID = id; NotifyOwner();}
+  void            SetCharge (const float &charge) {fCharge = charge; NotifyOwner();}
+  void            SetP (TLorentzVector *p) {fP = p; fCached = 0; NotifyOwner();}
+  void            SetVector (TLorentzVector *vec) {fP = vec; fCached = 0; NotifyOwner();}
+  //! Must be called if the four-vector is changed through GetP
+  void            InvalidateKinematics () {fCached = 0; NotifyOwner();}
   void            SetAttribute (const TString &name, const long double &value);
+  void            SetAttribute (const DataKey &key, const long double &value);
+  void            SetAttributeData (GenericData *data, size_t row) {fAttributeData = data; fAttributeRow = row;}
   void            SetParticle (const TString &name, GenericParticle *particle, const long long &index = -1);
-  void            SetParticles (const TString &name, std::vector<GenericParticle*> &particles);
+  void            SetParticle (const DataKey &name, GenericParticle *particle, const long long &index = -1);
+  void            SetParticles (const TString &name, const std::vector<GenericParticle*> &particles);
+  void            SetParticles (const DataKey &name, const std::vector<GenericParticle*> &particles);
   inline TString  GetOwner () {return fOwner;}
   inline TString  GetOrigin () {return fOrigin;}
+  inline const DataKey&     GetOriginKey () {if (!fOriginKey.IsValid()) fOriginKey = DataKey(fOrigin); return fOriginKey;}
   inline size_t   GetOwnerIndex () {return fOriginIndex;}
   inline size_t   GetOriginIndex () {return fOriginIndex;}
+  inline bool     HasOriginIndex () {return fHasOriginIndex;}
+  //! Key shared by a particle and its copies
+  /*!
+   * Built from the origin and the origin index, or from the particle's 
+   * address if no origin index was set (so such particles are never 
+   * taken for one another, but neither are their copies).
+   */
+  unsigned long long        GetIdentity ();
   inline int      GetID () {return fID;}
   inline float    GetCharge () {return fCharge;}
   inline TLorentzVector*    GetP () {return fP;}
   inline TLorentzVector*    GetVector () {return fP;}
-  inline long double        GetAttribute (const TString &name) {return fScalarAttributes[name];}
-  inline std::map<TString, long double, HAL::internal::string_cmp>&  GetAttributes () {return fScalarAttributes;}
-  inline ParticlePtr        GetParticle (const TString &name, const long long &index) {return f1DParticles[name][index];}
-  inline ParticlePtrs&      GetParticles (const TString &name) {return f1DParticles[name];}
+  //! Kinematics of the four-vector (each computed at most once per SetP)
+  inline double             GetKinematic (Kinematic k) {return (fCached & (1u << k)) ? fKinematics[k] : CacheKinematic(k);}
+  inline double             GetPt () {return GetKinematic(kPt);}
+  inline double             GetEta () {return GetKinematic(kEta);}
+  inline double             GetPhi () {return GetKinematic(kPhi);}
+  inline double             GetM () {return GetKinematic(kM);}
+  inline double             GetE () {return GetKinematic(kE);}
+  inline double             GetEt () {return GetKinematic(kEt);}
+  inline double             GetP3 () {return GetKinematic(kP3);}
+  inline double             GetRapidity () {return GetKinematic(kRapidity);}
+  //! Same as TLorentzVector::DeltaR and DeltaPhi, but from the cached eta and phi
+  double                    DeltaR (GenericParticle *particle);
+  double                    DeltaPhi (GenericParticle *particle);
+  long double               GetAttribute (const TString &name);
+  long double               GetAttribute (const DataKey &key);
+  //! Copy of every attribute of the particle (see GetAttribute)
+  /*!
+   * For a particle without an owner this is where its attributes live, so it
+   * may be changed. For an owned particle the attributes are kept in columns
+   * of the owner and changes to the copy are not stored; use SetAttribute.
+   */
+  std::map<TString, long double, HAL::internal::string_cmp>&  GetAttributes ();
+  inline GenericData*       GetAttributeData () {return fAttributeData;}
+  inline size_t             GetAttributeRow () {return fAttributeRow;}
+  inline ParticlePtr        GetParticle (const TString &name, const long long &index) {return GetParticles(DataKey::Find(name))[index];}
+  //! Related particles (in insertion order), created if missing; the list may be changed
+  ParticlePtrs&             GetParticles (const TString &name);
+  //! Related particles (in insertion order) without creating or changing the list
+  const ParticlePtrs&       GetParticles (const DataKey &name);
+  //! Mask of the origin indices (modulo 64) of the related particles
+  unsigned long long        GetParticleMask (const DataKey &name);
+
+  bool            HasAttribute (const TString &name);
+  bool            HasAttribute (const DataKey &key);
+  inline bool     HasParticles (const TString &name) {return HasParticles(DataKey::Find(name));}
+  inline bool     HasParticles (const DataKey &name) {return FindRelation(name) != nullptr;}
+  inline size_t   GetNParticles (const TString &name) {return GetNParticles(DataKey::Find(name));}
+  inline size_t   GetNParticles (const DataKey &name) {Relation *r = FindRelation(name); return r ? r->fParticles.size() : 0;}
+  //! True if both particles are related to the same particles (by origin and origin index)
+  bool            HasSameParticles (const TString &name, ParticlePtr particle) {return HasSameParticles(DataKey::Find(name), particle);}
+  bool            HasSameParticles (const DataKey &name, ParticlePtr particle);
+  //! True if the two relations have at least one particle in common
+  bool            SharesParticles (const DataKey &name, ParticlePtr particle);
 
-  inline bool     HasAttribute (const TString &name) {return (fScalarAttributes.count(name) == 0) ? false : true;}
-  inline bool     HasParticles (const TString &name) {return (f1DParticles.count(name) == 0) ? false : true;}
-  inline size_t   GetNParticles (const TString &name) {return HasParticles(name) ? f1DParticles[name].size() : 0;}
-  bool            HasSameParticles (const TString &name, ParticlePtr particle);
+private:
+  double          CacheKinematic (Kinematic k);
+  inline void     NotifyOwner () {if (fAttributeData != nullptr) InvalidateOwner();}
+  void            InvalidateOwner ();
 
+public:
   friend std::ostream& operator<<(std::ostream& os, const GenericParticle &particle);
   
   ClassDef(GenericParticle, 0);
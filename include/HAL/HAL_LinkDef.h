@@ -9,10 +9,13 @@
 
 #pragma link C++ defined_in "HAL/Algorithm.h";
 #pragma link C++ defined_in "HAL/Algorithms/AttachAttribute.h";
+#pragma link C++ defined_in "HAL/Algorithms/ClusterJets.h";
 #pragma link C++ defined_in "HAL/Algorithms/Cut.h";
+#pragma link C++ defined_in "HAL/Algorithms/DerivedValue.h";
 #pragma link C++ defined_in "HAL/Algorithms/ImportParticle.h";
 #pragma link C++ defined_in "HAL/Algorithms/ImportValue.h";
 #pragma link C++ defined_in "HAL/Algorithms/Monitor.h";
+#pragma link C++ defined_in "HAL/Algorithms/SelectExpression.h";
 #pragma link C++ defined_in "HAL/Algorithms/SelectParticle.h";
 #pragma link C++ defined_in "HAL/Algorithms/SelectRank.h";
 #pragma link C++ defined_in "HAL/Algorithms/SelectRefParticle.h";
@@ -27,11 +30,19 @@
 #pragma link C++ defined_in "HAL/Common.h";
 #pragma link C++ defined_in "HAL/CutAlgorithm.h";
 #pragma link C++ defined_in "HAL/CutOptimizer.h";
+#pragma link C++ defined_in "HAL/DenseIndexMap.h";
+#pragma link C++ defined_in "HAL/EtaPhiGrid.h";
+#pragma link C++ defined_in "HAL/EventArena.h";
+#pragma link C++ defined_in "HAL/Expression.h";
 #pragma link C++ defined_in "HAL/GenericData.h";
 #pragma link C++ defined_in "HAL/GenericParticle.h";
 #pragma link C++ defined_in "HAL/Integrator.h";
 #pragma link C++ defined_in "HAL/Interpolator.h";
+#pragma link C++ defined_in "HAL/ObjectPool.h";
+#pragma link C++ defined_in "HAL/ParticleCollection.h";
 #pragma link C++ defined_in "HAL/PlotUtils.h";
+#pragma link C++ defined_in "HAL/RingBuffer.h";
+#pragma link C++ defined_in "HAL/StaticDataMap.h";
 
 // These are needed for the AnalysisTreeWriter class
 #pragma link C++ class vector<bool>+;
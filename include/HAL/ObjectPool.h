@@ -0,0 +1,110 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_ObjectPool
+#define HAL_ObjectPool
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+//! Pool of objects that are recycled instead of destroyed
+/*!
+ * Objects are constructed in fixed size chunks and stay constructed until
+ * the pool itself is destroyed. Reset only rewinds the pool, so the next
+ * event gets the same objects back through Recycle and the caller puts them
+ * into a fresh state. Only when more objects are needed than in any earlier
+ * event does Create construct new ones, so the number of constructions is
+ * bounded by the largest event instead of growing with every particle read.
+ */
+template <class T>
+class ObjectPool {
+public:
+  explicit ObjectPool (size_t chunk_size = 256) :
+    fChunkSize(chunk_size == 0 ? 1 : chunk_size), fSize(0), fInUse(0), fHighWaterMark(0) {}
+  ~ObjectPool () {Release();}
+
+  //! Next previously constructed object or nullptr if all are in use
+  T*        Recycle ()
+  {
+    if (fInUse == fSize)
+      return nullptr;
+    T *object = At(fInUse);
+    ++fInUse;
+    return object;
+  }
+
+  //! Construct a new object (only valid if Recycle returned nullptr)
+  template <class ... Args>
+  T*        Create (Args&& ... args)
+  {
+    if (fSize == fChunks.size() * fChunkSize) {
+      void *memory = std::malloc(fChunkSize * sizeof(T));
+      if (memory == nullptr)
+        throw std::bad_alloc();
+      fChunks.push_back(static_cast<T*>(memory));
+    }
+    T *object = ::new (static_cast<void*>(At(fSize))) T(std::forward<Args>(args)...);
+    ++fSize;
+    ++fInUse;
+    return object;
+  }
+
+  //! Make every object available for recycling
+  void      Reset ()
+  {
+    if (fInUse > fHighWaterMark)
+      fHighWaterMark = fInUse;
+    fInUse = 0;
+  }
+
+  //! Destroy every object and free all memory
+  void      Release ()
+  {
+    Reset();
+    for (size_t i = fSize; i > 0; --i)
+      At(i - 1)->~T();
+    for (size_t i = 0; i < fChunks.size(); ++i)
+      std::free(fChunks[i]);
+    fChunks.clear();
+    fSize = 0;
+  }
+
+  //! Number of objects constructed so far
+  size_t    GetSize () const {return fSize;}
+  size_t    GetInUse () const {return fInUse;}
+  //! Largest number of objects used in a single event
+  size_t    GetHighWaterMark () const {return fInUse > fHighWaterMark ? fInUse : fHighWaterMark;}
+  //! Memory of the chunks the objects are constructed in
+  size_t    GetNChunks () const {return fChunks.size();}
+  const void* GetChunk (size_t i) const {return fChunks[i];}
+  size_t    GetChunkBytes () const {return fChunkSize * sizeof(T);}
+
+private:
+  T*        At (size_t i) const {return fChunks[i / fChunkSize] + i % fChunkSize;}
+
+  size_t            fChunkSize;
+  size_t            fSize;
+  size_t            fInUse;
+  size_t            fHighWaterMark;
+  std::vector<T*>   fChunks;
+
+  ObjectPool (const ObjectPool&);
+  ObjectPool& operator= (const ObjectPool&);
+};
+
+} /* internal */
+
+} /* HAL */
+
+#endif
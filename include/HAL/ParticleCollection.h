@@ -0,0 +1,165 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_ParticleCollection
+#define HAL_ParticleCollection
+
+#include <cstddef>
+#include <vector>
+#include <HAL/Common.h>
+#include <HAL/GenericParticle.h>
+
+namespace HAL
+{
+
+class GenericData;
+class ParticleCollection;
+
+//! Lightweight reference to one particle of a ParticleCollection
+/*!
+ * A handle is a collection pointer plus an index, so it is cheap to copy
+ * and reads its kinematics from the collection's columns. The full
+ * GenericParticle is still reachable through GetParticle or operator->.
+ */
+class ParticleHandle {
+public:
+  ParticleHandle () : fCollection(nullptr), fIndex(0) {}
+  ParticleHandle (const ParticleCollection *collection, size_t index) :
+    fCollection(collection), fIndex(index) {}
+
+  inline bool         IsValid () const {return fCollection != nullptr;}
+  inline size_t       GetIndex () const {return fIndex;}
+  inline double       Pt () const;
+  inline double       Eta () const;
+  inline double       Phi () const;
+  inline double       M () const;
+  inline double       Px () const;
+  inline double       Py () const;
+  inline double       Pz () const;
+  inline double       E () const;
+  inline float        GetCharge () const;
+  inline int          GetID () const;
+  inline size_t       GetOriginIndex () const;
+  inline ParticlePtr  GetParticle () const;
+  inline ParticlePtr  operator-> () const {return GetParticle();}
+
+private:
+  const ParticleCollection *fCollection;
+  size_t                    fIndex;
+};
+
+//! Structure-of-arrays view of a list of particles
+/*!
+ * Every per-particle quantity is stored in its own contiguous array so that
+ * selection and ranking loops run over flat memory instead of chasing
+ * GenericParticle and TLorentzVector pointers. Charge, id and origin index
+ * are copied when the collection is built. The polar (pt, eta, phi, m) and
+ * cartesian (px, py, pz, E) columns are only filled the first time one of
+ * their arrays is requested, since most algorithms use one set or the
+ * other. The polar values come from the particles' cached kinematics (see
+ * GenericParticle::GetKinematic), so they are computed at most once per
+ * particle and are identical to calling the TLorentzVector methods. A
+ * collection built with Select is a subset of another collection and takes
+ * its columns from there.\n\n
+ * __Note:__ the collection is a copy of the particles, not their storage.
+ * Writing to its arrays does not change the particles, and changing a
+ * particle does not change arrays that were already handed out. The
+ * GenericParticle setters (SetP, SetCharge, InvalidateKinematics, ...) mark
+ * the owning GenericData out of date, and it and the selections made from it
+ * rebuild their collections on the next GenericData::GetCollection call.
+ * Pointers into an old collection must not be kept across such changes. A
+ * four-vector modified through GenericParticle::GetP is only seen after
+ * InvalidateKinematics, and a container holding particles it does not own
+ * must be refreshed with GenericData::InvalidateCollection.
+ */
+class ParticleCollection {
+public:
+  ParticleCollection () : fData(nullptr), fParent(nullptr), fHasPolar(false), fHasCartesian(false) {}
+
+  //! Rebuild the collection from a range of particles
+  /*!
+   * data is the container the particles were taken from. Its attribute
+   * overlays are used by GatherAttribute.
+   */
+  void          Assign (ParticlePtrsConstIt first, ParticlePtrsConstIt last, 
+                        GenericData *data = nullptr);
+  //! Build the collection from the entries indices of parent
+  /*!
+   * The columns are gathered from parent's columns, so a chain of selections
+   * computes every kinematic quantity only once. parent must stay valid (and
+   * unchanged) as long as this collection is used.
+   */
+  void          Select (const ParticleCollection &parent, const std::vector<size_t> &indices, 
+                        GenericData *data = nullptr);
+  //! Provide the cartesian columns instead of reading them from the particles
+  /*!
+   * For producers that computed the four-vectors column-wise anyway. The
+   * values must be those of the particles' four-vectors, in collection order.
+   */
+  void          SetCartesian (const double *px, const double *py, const double *pz, const double *e);
+  //! Remove every particle (the capacity is kept for reuse)
+  void          Clear ();
+  void          Reserve (size_t n);
+
+  inline size_t GetSize () const {return fParticles.size();}
+  inline bool   IsEmpty () const {return fParticles.empty();}
+
+  //! Columns (valid until the collection is rebuilt or cleared)
+  const double* GetPt () const {FillPolar(); return fPt.data();}
+  const double* GetEta () const {FillPolar(); return fEta.data();}
+  const double* GetPhi () const {FillPolar(); return fPhi.data();}
+  const double* GetM () const {FillPolar(); return fM.data();}
+  const double* GetPx () const {FillCartesian(); return fPx.data();}
+  const double* GetPy () const {FillCartesian(); return fPy.data();}
+  const double* GetPz () const {FillCartesian(); return fPz.data();}
+  const double* GetE () const {FillCartesian(); return fE.data();}
+  const float*  GetCharge () const {return fCharge.data();}
+  const int*    GetID () const {return fID.data();}
+  const size_t* GetOriginIndex () const {return fOriginIndex.data();}
+
+  //! Fill values with attribute key of every particle (0 where it is missing)
+  /*!
+   * Each value is read by index from the attribute columns of the container
+   * the collection was built from (see GenericData::GatherAttribute) or,
+   * without one, as the particle itself sees it (see GenericParticle::GetAttribute).
+   * Returns false if any particle lacks the attribute.
+   */
+  bool          GatherAttribute (const DataKey &key, std::vector<long double> &values) const;
+
+  inline ParticlePtr    GetParticle (size_t i) const {return fParticles[i];}
+  inline ParticleHandle operator[] (size_t i) const {return ParticleHandle(this, i);}
+
+private:
+  void          FillPolar () const;
+  void          FillCartesian () const;
+
+  GenericData                  *fData;
+  const ParticleCollection     *fParent;
+  std::vector<size_t>           fParentIndex;
+  ParticlePtrs                  fParticles;
+  std::vector<float>            fCharge;
+  std::vector<int>              fID;
+  std::vector<size_t>           fOriginIndex;
+  mutable bool                  fHasPolar, fHasCartesian;
+  mutable std::vector<double>   fPt, fEta, fPhi, fM;
+  mutable std::vector<double>   fPx, fPy, fPz, fE;
+};
+
+inline double ParticleHandle::Pt () const {return fCollection->GetPt()[fIndex];}
+inline double ParticleHandle::Eta () const {return fCollection->GetEta()[fIndex];}
+inline double ParticleHandle::Phi () const {return fCollection->GetPhi()[fIndex];}
+inline double ParticleHandle::M () const {return fCollection->GetM()[fIndex];}
+inline double ParticleHandle::Px () const {return fCollection->GetPx()[fIndex];}
+inline double ParticleHandle::Py () const {return fCollection->GetPy()[fIndex];}
+inline double ParticleHandle::Pz () const {return fCollection->GetPz()[fIndex];}
+inline double ParticleHandle::E () const {return fCollection->GetE()[fIndex];}
+inline float ParticleHandle::GetCharge () const {return fCollection->GetCharge()[fIndex];}
+inline int ParticleHandle::GetID () const {return fCollection->GetID()[fIndex];}
+inline size_t ParticleHandle::GetOriginIndex () const {return fCollection->GetOriginIndex()[fIndex];}
+inline ParticlePtr ParticleHandle::GetParticle () const {return fCollection->GetParticle(fIndex);}
+
+} /* HAL */
+
+#endif
@@ -0,0 +1,87 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_RingBuffer
+#define HAL_RingBuffer
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+//! Fixed size queue between one producing and one consuming thread
+/*!
+ * Push and Pop never lock or allocate: each side only writes its own index
+ * and reads the other one, so the event loop can hand records to a
+ * background thread at the cost of a copy. When the consumer falls behind
+ * the buffer fills up and Push refuses new records instead of waiting; the
+ * refused records are counted by GetNDropped. The capacity is rounded up to
+ * a power of two.
+ */
+template <class T>
+class RingBuffer {
+public:
+  explicit RingBuffer (size_t capacity = 1024) : fHead(0), fTail(0), fNDropped(0)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+    fSlots.resize(size);
+    fMask = size - 1;
+  }
+
+  //! Copy value into the buffer (producer only); false if the buffer is full
+  bool      Push (const T &value)
+  {
+    size_t head = fHead.load(std::memory_order_relaxed);
+
+    if (head - fTail.load(std::memory_order_acquire) > fMask) {
+      fNDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    fSlots[head & fMask] = value;
+    fHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Move the oldest record into value (consumer only); false if the buffer is empty
+  bool      Pop (T &value)
+  {
+    size_t tail = fTail.load(std::memory_order_relaxed);
+
+    if (tail == fHead.load(std::memory_order_acquire))
+      return false;
+    value = fSlots[tail & fMask];
+    fTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t    GetCapacity () const {return fMask + 1;}
+  //! Number of records refused because the buffer was full
+  size_t    GetNDropped () const {return fNDropped.load(std::memory_order_relaxed);}
+
+private:
+  std::vector<T>        fSlots;
+  size_t                fMask;
+  // the indices only ever increase; they are reduced modulo the capacity
+  // when used, so full and empty are told apart without a spare slot
+  std::atomic<size_t>   fHead; // next slot to write
+  std::atomic<size_t>   fTail; // next slot to read
+  std::atomic<size_t>   fNDropped;
+
+  RingBuffer (const RingBuffer&);
+  RingBuffer& operator= (const RingBuffer&);
+};
+
+} /* internal */
+
+} /* HAL */
+
+#endif
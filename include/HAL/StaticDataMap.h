@@ -0,0 +1,273 @@
+/*!
+ * \file
+ * \author  Jeff Hetherly <jhetherly@smu.edu>
+ */
+
+#ifndef HAL_StaticDataMap
+#define HAL_StaticDataMap
+
+#include <type_traits>
+#include <string>
+#include <deque>
+#include <vector>
+#include <tuple>
+#include <TString.h>
+#include <HAL/Common.h>
+#include <HAL/Exceptions.h>
+
+namespace HAL
+{
+
+namespace StaticDataMap_internal {
+
+  // position of T in the parameter pack Types (fails to compile if absent)
+  template <class T, class ... Types> struct type_index;
+
+  template <class T, class ... Types>
+  struct type_index<T, T, Types...> : std::integral_constant<unsigned, 0> {};
+
+  template <class T, class U, class ... Types>
+  struct type_index<T, U, Types...> :
+    std::integral_constant<unsigned, 1 + type_index<T, Types...>::value> {};
+
+  // storage policy for plain single values
+  template <class T> using value_t = T;
+
+  // storage for all names of one type
+  template <class Stored>
+  struct column {
+    std::deque<Stored>     fValues;  // deque keeps handles valid as the column grows
+    std::vector<unsigned>  fSlotOf;  // DataKey id -> position in fValues + 1 (0 = none)
+  };
+
+}
+
+//! Typed key-value store resolved at compile time
+/*!
+ * Every type in Types gets its own column and the column for a value is
+ * picked from the static type (no runtime type switch). Names are interned
+ * into DataKeys, so a lookup is a hash of the name (or nothing at all when a
+ * DataKey or Handle is used) followed by array indexing. A name is bound to
+ * a single type until it is removed.
+ *
+ * StoredType is a template alias mapping each type to what is actually
+ * stored for it:
+ *        ex: for just storing single values of a given type - template <class T> using StoredType = T;
+ *        ex: for storing tuples of values of a given type with a bool - template <class T> using StoredType = std::tuple<T, bool>;
+ */
+template <template <class> class StoredType, class ... Types>
+class StaticDataMap {
+public:
+  enum {kNoType = sizeof...(Types)};
+
+  template <class T> using Stored_t = StoredType<T>;
+
+  //! Typed reference to the value of one name
+  /*!
+   * A handle is resolved once and then dereferences straight to the stored
+   * value. It stays valid for the lifetime of the map.
+   */
+  template <class T>
+  class Handle {
+  public:
+    Handle () : fValue(nullptr) {}
+
+    bool          IsValid () const {return fValue != nullptr;}
+    Stored_t<T>&  operator* () const {return *fValue;}
+    Stored_t<T>*  operator-> () const {return fValue;}
+
+  private:
+    friend class StaticDataMap;
+    explicit Handle (Stored_t<T> *value) : fValue(value) {}
+
+    Stored_t<T>  *fValue;
+  };
+
+  class StaticDataMap_Proxy {
+    StaticDataMap &fMap;
+    DataKey        fKey;
+
+  public:
+    StaticDataMap_Proxy (StaticDataMap &map, const DataKey &key) :
+      fMap(map), fKey(key) {}
+
+    template <class Ref>
+    operator Ref () const
+    {
+      return fMap.template get<Ref>(fKey);
+    }
+
+    template <class Ref>
+    StaticDataMap& operator= (const Ref &val)
+    {
+      fMap.set(fKey, val);
+      return fMap;
+    }
+  };
+
+  virtual ~StaticDataMap () {}
+
+  //! Compile-time position of T in the list of stored types
+  template <class T>
+  static constexpr unsigned type_index () {return StaticDataMap_internal::type_index<T, Types...>::value;}
+
+  //! Storage for key, binding key to type T if it is not yet bound
+  template <class T>
+  Stored_t<T>& access (const DataKey &key)
+  {
+    const unsigned type = type_index<T>();
+    StaticDataMap_internal::column<Stored_t<T> > &col = column<T>();
+
+    if (!key.IsValid())
+      throw HALException("StaticDataMap: invalid key");
+
+    unsigned id = key.GetID();
+    if (id >= fTypeOf.size())
+      fTypeOf.resize(id + 1, kNoType);
+    if (id >= col.fSlotOf.size())
+      col.fSlotOf.resize(id + 1, 0);
+
+    if (fTypeOf[id] != type) {
+      if (fTypeOf[id] != kNoType)
+        throw HALException(key.GetName().Prepend("StaticDataMap: name is stored with a different type: "));
+      fTypeOf[id] = type;
+      // reuse the old slot (if any) so that handles stay valid
+      if (col.fSlotOf[id] == 0) {
+        col.fValues.push_back(Stored_t<T>());
+        col.fSlotOf[id] = col.fValues.size();
+      }
+      else
+        col.fValues[col.fSlotOf[id] - 1] = Stored_t<T>();
+    }
+    return col.fValues[col.fSlotOf[id] - 1];
+  }
+
+  template <class T>
+  Stored_t<T>& access (const std::string &name) {return access<T>(DataKey(name));}
+
+  template <class T>
+  Handle<T> handle (const DataKey &key) {return Handle<T>(&access<T>(key));}
+
+  template <class T>
+  Handle<T> handle (const std::string &name) {return handle<T>(DataKey(name));}
+
+  template <class T>
+  const Stored_t<T>& get (const DataKey &key) const
+  {
+    if (!this->template exists<T>(key))
+      throw HALException(key.GetName().Prepend("StaticDataMap: key does not exist for this type: "));
+    const StaticDataMap_internal::column<Stored_t<T> > &col = column<T>();
+    return col.fValues[col.fSlotOf[key.GetID()] - 1];
+  }
+
+  template <class T>
+  const Stored_t<T>& get (const std::string &name) const
+  {
+    DataKey key = DataKey::Find(name);
+
+    if (!key.IsValid())
+      throw HALException(TString(name.c_str()).Prepend("StaticDataMap: key does not exist: "));
+    return get<T>(key);
+  }
+
+  template <class T>
+  const Stored_t<T>& get (const Handle<T> &h) const {return *h;}
+
+  template <class T, class Key>
+  void get (const Key &key, T &val) const
+  {
+    val = this->template get<T>(key);
+  }
+
+  template <class T>
+  void set (const DataKey &key, const T &val)
+  {
+    this->template access<T>(key) = val;
+  }
+
+  template <class T>
+  void set (const std::string &name, const T &val) {set(DataKey(name), val);}
+
+  template <class T>
+  void set (const Handle<T> &h, const Stored_t<T> &val) {*h = val;}
+
+  //! True if key is stored (with any type)
+  bool exists (const DataKey &key) const
+  {
+    return key.IsValid() && key.GetID() < fTypeOf.size() && fTypeOf[key.GetID()] != kNoType;
+  }
+
+  bool exists (const std::string &name) const {return exists(DataKey::Find(name));}
+
+  //! True if key is stored with type T
+  template <class T>
+  bool exists (const DataKey &key) const
+  {
+    return exists(key) && fTypeOf[key.GetID()] == type_index<T>();
+  }
+
+  //! Unbind key (its storage is kept for reuse)
+  void remove (const DataKey &key)
+  {
+    if (exists(key))
+      fTypeOf[key.GetID()] = kNoType;
+  }
+
+  void remove (const std::string &name) {remove(DataKey::Find(name));}
+
+  //! Unbind every key (storage and handles are kept)
+  void clear () {fTypeOf.assign(fTypeOf.size(), kNoType);}
+
+  //! Call f(name, value) for every stored value
+  /*!
+   * f must accept the stored value of every type, e.g. through a templated
+   * operator().
+   */
+  template <class Func>
+  void for_each (Func &&f)
+  {
+    ForEach<0>(f);
+  }
+
+  StaticDataMap_Proxy operator[] (const std::string &key)
+  {
+    return StaticDataMap_Proxy(*this, DataKey(key));
+  }
+
+private:
+  std::tuple<StaticDataMap_internal::column<Stored_t<Types> >...>  fColumns;
+  std::vector<unsigned>                                             fTypeOf; // DataKey id -> type index
+
+  template <class T>
+  StaticDataMap_internal::column<Stored_t<T> >& column ()
+  {
+    return std::get<StaticDataMap_internal::type_index<T, Types...>::value>(fColumns);
+  }
+
+  template <class T>
+  const StaticDataMap_internal::column<Stored_t<T> >& column () const
+  {
+    return std::get<StaticDataMap_internal::type_index<T, Types...>::value>(fColumns);
+  }
+
+  template <unsigned I, class Func>
+  typename std::enable_if<I == sizeof...(Types), void>::type
+  ForEach (Func&) {}
+
+  template <unsigned I, class Func>
+  typename std::enable_if<(I < sizeof...(Types)), void>::type
+  ForEach (Func &f)
+  {
+    typename std::tuple_element<I, decltype(fColumns)>::type &col = std::get<I>(fColumns);
+
+    for (unsigned id = 0; id < col.fSlotOf.size(); ++id) {
+      if (col.fSlotOf[id] != 0 && fTypeOf[id] == I)
+        f(internal::SymbolTable::Name(id), col.fValues[col.fSlotOf[id] - 1]);
+    }
+    ForEach<I + 1>(f);
+  }
+};
+
+} /* HAL */
+
+#endif
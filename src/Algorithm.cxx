@@ -10,6 +10,7 @@
 #include <HAL/AnalysisData.h>
 #include <HAL/AnalysisTreeReader.h>
 #include <HAL/AnalysisTreeWriter.h>
+#include <HAL/EventArena.h>
 
 ClassImp(HAL::Algorithm);
 
@@ -19,7 +20,7 @@ namespace HAL
 //______________________________________________________________________________
 Algorithm::Algorithm (TString name, TString title) : 
   fPrintCounter(kFALSE), fAlgorithms(), fName(name), fTitle(title), 
-  fHasExecuted(kFALSE), fAbort(kFALSE), fDataList(nullptr), fAlgorithmType(""),  fCounter(0) 
+  fNameKey(name), fHasExecuted(kFALSE), fAbort(kFALSE), fEventArena(nullptr), fDataList(nullptr), fAlgorithmType(""),  fCounter(0) 
 {
 }
 
@@ -36,8 +37,10 @@ Algorithm::Algorithm (const Algorithm &other)
     fAlgorithms.push_back(algo);
   }
   fName = other.fName;
+  fNameKey = other.fNameKey;
   fTitle = other.fTitle;
   fDataList = other.fDataList; 
+  fEventArena = nullptr;
   fOption = other.fOption;
   fCounter = other.fCounter;
   fHasExecuted = kFALSE;
@@ -282,11 +285,59 @@ void Algorithm::TerminateAlgo (Option_t *option)
   Terminate(option);
 }
 
+//______________________________________________________________________________
+void Algorithm::FuseAlgos (Algorithm *flow) 
+{
+  // User should never call this.
+  // Sub-algorithms run between an algorithm and its next sibling, so only
+  // an algorithm without them is offered to the sibling, and only if no 
+  // other algorithm in the flow reads its result.
+
+  Algorithm *previous = nullptr;
+
+  if (flow == nullptr)
+    flow = this;
+#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
+  BOOST_FOREACH( Algorithm *algo, fAlgorithms )
+#else
+  for (auto algo: fAlgorithms)
+#endif
+  {
+    if (previous != nullptr && previous->fAlgorithms.empty() && 
+        algo->Reads(previous->GetName()) && flow->CountReaders(previous->GetName()) == 1)
+      algo->Fuse(previous);
+    algo->FuseAlgos(flow);
+    previous = algo;
+  }
+}
+
+//______________________________________________________________________________
+unsigned Algorithm::CountReaders (const TString &name) 
+{
+  // User should never call this.
+  // Number of sub-algorithms (at any depth) that may read name.
+
+  unsigned n = 0;
+
+#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
+  BOOST_FOREACH( Algorithm *algo, fAlgorithms )
+#else
+  for (auto algo: fAlgorithms)
+#endif
+  {
+    if (algo->Reads(name))
+      ++n;
+    n += algo->CountReaders(name);
+  }
+  return n;
+}
+
 //______________________________________________________________________________
 void Algorithm::AddData (TString name, TObject *obj) 
 {
   static_cast<TNamed*>(obj)->SetName(name.Data());
   fDataList->AddLast(obj);
+  ForgetData();
 }
 
 //______________________________________________________________________________
@@ -307,6 +358,7 @@ void Algorithm::AssignDataList (TList *list)
   // User should never call this.
 
   fDataList = list;
+  fEventArena = nullptr;
   // Assign data to all sub-algorithms
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( Algorithm *algo, fAlgorithms )
@@ -326,6 +378,23 @@ void Algorithm::DeleteData (TString name)
     throw HALException(name.Prepend("Couldn't find and delete data "));
   fDataList->Remove(obj);
   delete obj;
+  ForgetData();
+}
+
+//______________________________________________________________________________
+void Algorithm::ForgetData () 
+{
+  // Drop the remembered data objects of this algorithm and its sub-algorithms
+
+  fEventArena = nullptr;
+#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
+  BOOST_FOREACH( Algorithm *algo, fAlgorithms )
+#else
+  for (auto algo: fAlgorithms)
+#endif
+  {
+    algo->ForgetData();
+  }
 }
 
 //______________________________________________________________________________
@@ -346,6 +415,14 @@ AnalysisTreeWriter* Algorithm::GetUserOutput ()
   return static_cast<AnalysisTreeWriter*>(fDataList->FindObject("UserOutput"));
 }
 
+//______________________________________________________________________________
+EventArena* Algorithm::GetEventArena () 
+{
+  if (fEventArena == nullptr)
+    fEventArena = static_cast<EventArena*>(fDataList->FindObject("EventArena"));
+  return fEventArena;
+}
+
 //______________________________________________________________________________
 Algorithm* Algorithm::GetAlgorithm (TString name) 
 {
@@ -1,524 +1,788 @@
 #include <HAL/AnalysisData.h>
-#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-#include <aux/boost/foreach.hpp>
-#endif
-#include <TRegexp.h>
 
 ClassImp(HAL::AnalysisData);
 
 namespace HAL
 {
 
+namespace
+{
+
+// Reinterpret the value a DataSlot points at
+template <class T>
+inline T& SlotValue (void *value) {return *static_cast<T*>(value);}
+
+template <class T>
+inline bool InnerCount (const internal::DenseIndexMap<internal::DenseIndexMap<T> > &m, 
+                        const long long &i, const long long &j) 
+{
+  const internal::DenseIndexMap<T> *inner = m.find(i);
+  return inner != nullptr && inner->count(j) == 1;
+}
+
+} /* anonymous */
+
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const bool &v) 
+void AnalysisData::RegisterName (const DataKey &key, StorageType type) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
-  // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kB;
-  else if (fNameTypeMap[name] != kB)
-    throw HALException(name.insert(0, "Cannot reassign bool storage container for "));
+  fNameTypeMap[key.GetString()] = type;
+  slot.fType = type;
+  slot.fRegistered = true;
+  slot.fValue = nullptr;
+}
 
-  fBoolMap[name] = v;
+//______________________________________________________________________________
+DataKey AnalysisData::RetrievalKey (const TString &n) 
+{
+  DataKey key = DataKey::Find(n);
+
+  if (FindSlot(key) == nullptr && FindProvider(key) == nullptr)
+    throw HALException(TString(n).Prepend("Error retrieving data: "));
+  return key;
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const bool &v) 
+{
+  SetValue(DataKey(n), v);
 }
 
 //______________________________________________________________________________
 void AnalysisData::SetValue (const TString &n, const long double &v) 
 {
-  std::string name(n.Data());
+  SetValue(DataKey(n), v);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const long long &v) 
+{
+  SetValue(DataKey(n), v);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const unsigned long long &v) 
+{
+  SetValue(DataKey(n), v);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const std::string &v) 
+{
+  SetValue(DataKey(n), v);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, TObject *v) 
+{
+  SetValue(DataKey(n), v);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const bool &v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const long double &v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const long long &v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const unsigned long long &v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const std::string &v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, TObject *v, const long long &i) 
+{
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const bool &v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const long double &v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const long long &v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const unsigned long long &v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, const std::string &v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const TString &n, TObject *v, const long long &i, const long long &j) 
+{
+  SetValue(DataKey(n), v, i, j);
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetValue (const DataKey &key, const bool &v) 
+{
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kD;
-  else if (fNameTypeMap[name] == kI)
-    SetValue(name, (long long)v);
-  else if (fNameTypeMap[name] == kC && v >= 0.0)
-    SetValue(name, (unsigned long long)v);
-  else if (fNameTypeMap[name] != kD)
-    throw HALException(name.insert(0, "Cannot reassign decimal storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kB);
+  else if (slot.fType != kB)
+    throw HALException(key.GetName().Prepend("Cannot reassign bool storage container for "));
 
-  fDecimalMap[name] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<bool>(key);
+  SlotValue<bool>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const long long &v) 
+void AnalysisData::SetValue (const DataKey &key, const long double &v) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kI;
-  else if (fNameTypeMap[name] == kD)
-    SetValue(name, (long double)v);
-  else if (fNameTypeMap[name] == kC && v >= 0)
-    SetValue(name, (unsigned long long)v);
-  else if (fNameTypeMap[name] != kI)
-    throw HALException(name.insert(0, "Cannot reassign integer storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kD);
+  else if (slot.fType == kI) {
+    AnalysisData::SetValue(key, (long long)v);
+    return;
+  }
+  else if (slot.fType == kC && v >= 0.0) {
+    AnalysisData::SetValue(key, (unsigned long long)v);
+    return;
+  }
+  else if (slot.fType != kD)
+    throw HALException(key.GetName().Prepend("Cannot reassign decimal storage container for "));
 
-  fIntegerMap[name] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<long double>(key);
+  SlotValue<long double>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const unsigned long long &v) 
+void AnalysisData::SetValue (const DataKey &key, const long long &v) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kC;
-  else if (fNameTypeMap[name] == kD)
-    SetValue(name, (long double)v);
-  else if (fNameTypeMap[name] == kI)
-    SetValue(name, (long long)v);
-  else if (fNameTypeMap[name] != kC)
-    throw HALException(name.insert(0, "Cannot reassign counting storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kI);
+  else if (slot.fType == kD) {
+    AnalysisData::SetValue(key, (long double)v);
+    return;
+  }
+  else if (slot.fType == kC && v >= 0) {
+    AnalysisData::SetValue(key, (unsigned long long)v);
+    return;
+  }
+  else if (slot.fType != kI)
+    throw HALException(key.GetName().Prepend("Cannot reassign integer storage container for "));
 
-  fCountingMap[name] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<long long>(key);
+  SlotValue<long long>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const std::string &v) 
+void AnalysisData::SetValue (const DataKey &key, const unsigned long long &v) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kS;
-  else if (fNameTypeMap[name] != kS)
-    throw HALException(name.insert(0, "Cannot reassign string storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kC);
+  else if (slot.fType == kD) {
+    AnalysisData::SetValue(key, (long double)v);
+    return;
+  }
+  else if (slot.fType == kI) {
+    AnalysisData::SetValue(key, (long long)v);
+    return;
+  }
+  else if (slot.fType != kC)
+    throw HALException(key.GetName().Prepend("Cannot reassign counting storage container for "));
 
-  fStringMap[name] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<unsigned long long>(key);
+  SlotValue<unsigned long long>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, TObject *v) 
-{ 
-  std::string name(n.Data());
+void AnalysisData::SetValue (const DataKey &key, const std::string &v) 
+{
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kO;
-  else if (fNameTypeMap[name] != kO)
-    throw HALException(name.insert(0, "Cannot reassign TObject storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kS);
+  else if (slot.fType != kS)
+    throw HALException(key.GetName().Prepend("Cannot reassign string storage container for "));
 
-  fTObjectMap[name] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<std::string>(key);
+  SlotValue<std::string>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const bool &v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, TObject *v) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIB;
-  else if (fNameTypeMap[name] != kIB)
-    throw HALException(name.insert(0, "Cannot reassign 1D bool storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kO);
+  else if (slot.fType != kO)
+    throw HALException(key.GetName().Prepend("Cannot reassign TObject storage container for "));
 
-  fBoolIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fScalarMap.access<TObject*>(key);
+  SlotValue<TObject*>(slot.fValue) = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const long double &v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, const bool &v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kID;
-  else if (fNameTypeMap[name] == kII)
-    SetValue(name, (long long)v, i);
-  else if (fNameTypeMap[name] == kIC && v >= 0.0)
-    SetValue(name, (unsigned long long)v, i);
-  else if (fNameTypeMap[name] != kID)
-    throw HALException(name.insert(0, "Cannot reassign 1D decimal storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIB);
+  else if (slot.fType != kIB)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D bool storage container for "));
 
-  fDecimalIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fBoolIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<bool> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const long long &v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, const long double &v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kII;
-  else if (fNameTypeMap[name] == kID)
-    SetValue(name, (long double)v, i);
-  else if (fNameTypeMap[name] == kIC && v >= 0)
-    SetValue(name, (unsigned long long)v, i);
-  else if (fNameTypeMap[name] != kII)
-    throw HALException(name.insert(0, "Cannot reassign 1D integer storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kID);
+  else if (slot.fType == kII) {
+    AnalysisData::SetValue(key, (long long)v, i);
+    return;
+  }
+  else if (slot.fType == kIC && v >= 0.0) {
+    AnalysisData::SetValue(key, (unsigned long long)v, i);
+    return;
+  }
+  else if (slot.fType != kID)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D decimal storage container for "));
 
-  fIntegerIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fDecimalIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<long double> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const unsigned long long &v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, const long long &v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIC;
-  else if (fNameTypeMap[name] == kID)
-    SetValue(name, (long double)v, i);
-  else if (fNameTypeMap[name] == kII)
-    SetValue(name, (long long)v, i);
-  else if (fNameTypeMap[name] != kIC)
-    throw HALException(name.insert(0, "Cannot reassign 1D counting storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kII);
+  else if (slot.fType == kID) {
+    AnalysisData::SetValue(key, (long double)v, i);
+    return;
+  }
+  else if (slot.fType == kIC && v >= 0) {
+    AnalysisData::SetValue(key, (unsigned long long)v, i);
+    return;
+  }
+  else if (slot.fType != kII)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D integer storage container for "));
 
-  fCountingIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fIntegerIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<long long> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const std::string &v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, const unsigned long long &v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIS;
-  else if (fNameTypeMap[name] != kIS)
-    throw HALException(name.insert(0, "Cannot reassign 1D string storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIC);
+  else if (slot.fType == kID) {
+    AnalysisData::SetValue(key, (long double)v, i);
+    return;
+  }
+  else if (slot.fType == kII) {
+    AnalysisData::SetValue(key, (long long)v, i);
+    return;
+  }
+  else if (slot.fType != kIC)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D counting storage container for "));
 
-  fStringIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fCountingIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<unsigned long long> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, TObject *v, const long long &i) 
+void AnalysisData::SetValue (const DataKey &key, const std::string &v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIO;
-  else if (fNameTypeMap[name] != kIO)
-    throw HALException(name.insert(0, "Cannot reassign 1D TObject storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIS);
+  else if (slot.fType != kIS)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D string storage container for "));
 
-  fTObjectIntMap[name][i] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fStringIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<std::string> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const bool &v, const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, TObject *v, const long long &i) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIIB;
-  else if (fNameTypeMap[name] != kIIB)
-    throw HALException(name.insert(0, "Cannot reassign 2D bool storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIO);
+  else if (slot.fType != kIO)
+    throw HALException(key.GetName().Prepend("Cannot reassign 1D TObject storage container for "));
 
-  fBoolIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fTObjectIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<TObject*> >(slot.fValue)[i] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const long double &v, const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, const bool &v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIID;
-  else if (fNameTypeMap[name] == kIII)
-    SetValue(name, (long long)v, i, j);
-  else if (fNameTypeMap[name] == kIIC && v >= 0.0)
-    SetValue(name, (unsigned long long)v, i, j);
-  else if (fNameTypeMap[name] != kIID)
-    throw HALException(name.insert(0, "Cannot reassign 2D decimal storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIIB);
+  else if (slot.fType != kIIB)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D bool storage container for "));
 
-  fDecimalIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fBoolIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<bool> > >(slot.fValue)[i][j] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const long long &v, const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, const long double &v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIII;
-  else if (fNameTypeMap[name] == kIID)
-    SetValue(name, (long double)v, i, j);
-  else if (fNameTypeMap[name] == kIIC && v >= 0)
-    SetValue(name, (unsigned long long)v, i, j);
-  else if (fNameTypeMap[name] != kIII)
-    throw HALException(name.insert(0, "Cannot reassign 2D integer storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIID);
+  else if (slot.fType == kIII) {
+    AnalysisData::SetValue(key, (long long)v, i, j);
+    return;
+  }
+  else if (slot.fType == kIIC && v >= 0.0) {
+    AnalysisData::SetValue(key, (unsigned long long)v, i, j);
+    return;
+  }
+  else if (slot.fType != kIID)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D decimal storage container for "));
 
-  fIntegerIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fDecimalIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long double> > >(slot.fValue)[i][j] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const unsigned long long &v, 
-                             const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, const long long &v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIIC;
-  else if (fNameTypeMap[name] == kIID)
-    SetValue(name, (long double)v, i, j);
-  else if (fNameTypeMap[name] == kIII)
-    SetValue(name, (long long)v, i, j);
-  else if (fNameTypeMap[name] != kIIC)
-    throw HALException(name.insert(0, "Cannot reassign 2D counting storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIII);
+  else if (slot.fType == kIID) {
+    AnalysisData::SetValue(key, (long double)v, i, j);
+    return;
+  }
+  else if (slot.fType == kIIC && v >= 0) {
+    AnalysisData::SetValue(key, (unsigned long long)v, i, j);
+    return;
+  }
+  else if (slot.fType != kIII)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D integer storage container for "));
 
-  fCountingIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fIntegerIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long long> > >(slot.fValue)[i][j] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, const std::string &v, 
-                             const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, const unsigned long long &v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIIS;
-  else if (fNameTypeMap[name] != kIIS)
-    throw HALException(name.insert(0, "Cannot reassign 2D string storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIIC);
+  else if (slot.fType == kIID) {
+    AnalysisData::SetValue(key, (long double)v, i, j);
+    return;
+  }
+  else if (slot.fType == kIII) {
+    AnalysisData::SetValue(key, (long long)v, i, j);
+    return;
+  }
+  else if (slot.fType != kIIC)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D counting storage container for "));
 
-  fStringIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fCountingIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > >(slot.fValue)[i][j] = v;
 }
 
 //______________________________________________________________________________
-void AnalysisData::SetValue (const TString &n, TObject *v, 
-                             const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, const std::string &v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
   // check if 'name' already has a container
-  if (!NameAlreadyStored(name))
-    fNameTypeMap[name] = kIIO;
-  else if (fNameTypeMap[name] != kIIO)
-    throw HALException(name.insert(0, "Cannot reassign 2D TObject storage container for "));
+  if (!slot.fRegistered)
+    RegisterName(key, kIIS);
+  else if (slot.fType != kIIS)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D string storage container for "));
 
-  fTObjectIntIntMap[name][i][j] = v;
+  if (slot.fValue == nullptr)
+    slot.fValue = &fStringIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<std::string> > >(slot.fValue)[i][j] = v;
 }
 
 //______________________________________________________________________________
-bool AnalysisData::GetBool (const TString &n, const long long &i, const long long &j) 
+void AnalysisData::SetValue (const DataKey &key, TObject *v, const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot &slot = GetSlot(key);
 
-  if (fBoolMap.count(name) != 0)
-    return fBoolMap[name];
-  if (fBoolIntMap.count(name) != 0)
-    return fBoolIntMap[name][i];
-  if (fBoolIntIntMap.count(name) != 0)
-    return fBoolIntIntMap[name][i][j];
+  // check if 'name' already has a container
+  if (!slot.fRegistered)
+    RegisterName(key, kIIO);
+  else if (slot.fType != kIIO)
+    throw HALException(key.GetName().Prepend("Cannot reassign 2D TObject storage container for "));
+
+  if (slot.fValue == nullptr)
+    slot.fValue = &fTObjectIntIntMap[key.GetString()];
+  SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<TObject*> > >(slot.fValue)[i][j] = v;
+}
+
+//______________________________________________________________________________
+template <class T>
+bool AnalysisData::GetNumber (DataSlot *slot, const long long &i, const long long &j, 
+                              T &value) 
+{
+  if (slot == nullptr || slot->fValue == nullptr)
+    return false;
+
+  switch (slot->fType) {
+    case kD:
+      value = SlotValue<long double>(slot->fValue); return true;
+    case kID:
+      value = SlotValue<internal::DenseIndexMap<long double> >(slot->fValue)[i]; return true;
+    case kIID:
+      value = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long double> > >(slot->fValue)[i][j]; return true;
+    case kI:
+      value = SlotValue<long long>(slot->fValue); return true;
+    case kII:
+      value = SlotValue<internal::DenseIndexMap<long long> >(slot->fValue)[i]; return true;
+    case kIII:
+      value = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long long> > >(slot->fValue)[i][j]; return true;
+    case kC:
+      value = SlotValue<unsigned long long>(slot->fValue); return true;
+    case kIC:
+      value = SlotValue<internal::DenseIndexMap<unsigned long long> >(slot->fValue)[i]; return true;
+    case kIIC:
+      value = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > >(slot->fValue)[i][j]; return true;
+    default:
+      return false;
+  }
+}
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+//______________________________________________________________________________
+bool AnalysisData::GetBool (const TString &n, const long long &i, const long long &j) 
+{
+  return GetBool(RetrievalKey(n), i, j);
 }
 
 //______________________________________________________________________________
 long double AnalysisData::GetDecimal (const TString &n, const long long &i, 
                                       const long long &j) 
 {
-  std::string name(n.Data());
+  return GetDecimal(RetrievalKey(n), i, j);
+}
 
-  if (fDecimalMap.count(name) != 0)
-    return fDecimalMap[name];
-  if (fDecimalIntMap.count(name) != 0)
-    return fDecimalIntMap[name][i];
-  if (fDecimalIntIntMap.count(name) != 0)
-    return fDecimalIntIntMap[name][i][j];
-  if (fIntegerMap.count(name) != 0)
-    return fIntegerMap[name];
-  if (fIntegerIntMap.count(name) != 0)
-    return fIntegerIntMap[name][i];
-  if (fIntegerIntIntMap.count(name) != 0)
-    return fIntegerIntIntMap[name][i][j];
-  if (fCountingMap.count(name) != 0)
-    return fCountingMap[name];
-  if (fCountingIntMap.count(name) != 0)
-    return fCountingIntMap[name][i];
-  if (fCountingIntIntMap.count(name) != 0)
-    return fCountingIntIntMap[name][i][j];
+//______________________________________________________________________________
+long long AnalysisData::GetInteger (const TString &n, const long long &i, 
+                                    const long long &j) 
+{
+  return GetInteger(RetrievalKey(n), i, j);
+}
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+//______________________________________________________________________________
+unsigned long long AnalysisData::GetCounting (const TString &n, 
+                                              const long long &i, const long long &j) 
+{
+  return GetCounting(RetrievalKey(n), i, j);
 }
 
 //______________________________________________________________________________
-long long AnalysisData::GetInteger (const TString &n, const long long &i, 
+TString AnalysisData::GetString (const TString &n, const long long &i, 
+                                 const long long &j) 
+{
+  return GetString(RetrievalKey(n), i, j);
+}
+
+//______________________________________________________________________________
+TObject* AnalysisData::GetTObject (const TString &n, const long long &i, 
+                                   const long long &j) 
+{
+  return GetTObject(RetrievalKey(n), i, j);
+}
+
+//______________________________________________________________________________
+bool AnalysisData::GetBool (const DataKey &key, const long long &i, const long long &j) 
+{
+  DataSlot *slot = ValueSlot(key);
+
+  if (slot != nullptr && slot->fValue != nullptr) {
+    if (slot->fType == kB)
+      return SlotValue<bool>(slot->fValue);
+    if (slot->fType == kIB)
+      return SlotValue<internal::DenseIndexMap<bool> >(slot->fValue)[i];
+    if (slot->fType == kIIB)
+      return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<bool> > >(slot->fValue)[i][j];
+  }
+
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
+}
+
+//______________________________________________________________________________
+long double AnalysisData::GetDecimal (const DataKey &key, const long long &i, 
+                                      const long long &j) 
+{
+  long double value;
+
+  if (GetNumber(ValueSlot(key), i, j, value))
+    return value;
+
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
+}
+
+//______________________________________________________________________________
+long long AnalysisData::GetInteger (const DataKey &key, const long long &i, 
                                     const long long &j) 
 {
-  std::string name(n.Data());
+  long long value;
 
-  if (fDecimalMap.count(name) != 0)
-    return fDecimalMap[name];
-  if (fDecimalIntMap.count(name) != 0)
-    return fDecimalIntMap[name][i];
-  if (fDecimalIntIntMap.count(name) != 0)
-    return fDecimalIntIntMap[name][i][j];
-  if (fIntegerMap.count(name) != 0)
-    return fIntegerMap[name];
-  if (fIntegerIntMap.count(name) != 0)
-    return fIntegerIntMap[name][i];
-  if (fIntegerIntIntMap.count(name) != 0)
-    return fIntegerIntIntMap[name][i][j];
-  if (fCountingMap.count(name) != 0)
-    return fCountingMap[name];
-  if (fCountingIntMap.count(name) != 0)
-    return fCountingIntMap[name][i];
-  if (fCountingIntIntMap.count(name) != 0)
-    return fCountingIntIntMap[name][i][j];
+  if (GetNumber(ValueSlot(key), i, j, value))
+    return value;
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
 }
 
 //______________________________________________________________________________
-unsigned long long AnalysisData::GetCounting (const TString &n, 
+unsigned long long AnalysisData::GetCounting (const DataKey &key, 
                                               const long long &i, const long long &j) 
 {
-  std::string name(n.Data());
+  unsigned long long value;
 
-  if (fDecimalMap.count(name) != 0)
-    return fDecimalMap[name];
-  if (fDecimalIntMap.count(name) != 0)
-    return fDecimalIntMap[name][i];
-  if (fDecimalIntIntMap.count(name) != 0)
-    return fDecimalIntIntMap[name][i][j];
-  if (fIntegerMap.count(name) != 0)
-    return fIntegerMap[name];
-  if (fIntegerIntMap.count(name) != 0)
-    return fIntegerIntMap[name][i];
-  if (fIntegerIntIntMap.count(name) != 0)
-    return fIntegerIntIntMap[name][i][j];
-  if (fCountingMap.count(name) != 0)
-    return fCountingMap[name];
-  if (fCountingIntMap.count(name) != 0)
-    return fCountingIntMap[name][i];
-  if (fCountingIntIntMap.count(name) != 0)
-    return fCountingIntIntMap[name][i][j];
+  if (GetNumber(ValueSlot(key), i, j, value))
+    return value;
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
 }
 
 //______________________________________________________________________________
-TString AnalysisData::GetString (const TString &n, const long long &i, 
+TString AnalysisData::GetString (const DataKey &key, const long long &i, 
                                  const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot *slot = ValueSlot(key);
 
-  if (fStringMap.count(name) != 0)
-    return fStringMap[name];
-  if (fStringIntMap.count(name) != 0)
-    return fStringIntMap[name][i];
-  if (fStringIntIntMap.count(name) != 0)
-    return fStringIntIntMap[name][i][j];
+  if (slot != nullptr && slot->fValue != nullptr) {
+    if (slot->fType == kS)
+      return SlotValue<std::string>(slot->fValue).c_str();
+    if (slot->fType == kIS)
+      return SlotValue<internal::DenseIndexMap<std::string> >(slot->fValue)[i].c_str();
+    if (slot->fType == kIIS)
+      return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<std::string> > >(slot->fValue)[i][j].c_str();
+  }
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
 }
 
 //______________________________________________________________________________
-TObject* AnalysisData::GetTObject (const TString &n, const long long &i, 
+TObject* AnalysisData::GetTObject (const DataKey &key, const long long &i, 
                                    const long long &j) 
 {
-  std::string name(n.Data());
+  DataSlot *slot = ValueSlot(key);
 
-  if (fTObjectMap.count(name) != 0)
-    return fTObjectMap[name];
-  if (fTObjectIntMap.count(name) != 0)
-    return fTObjectIntMap[name][i];
-  if (fTObjectIntIntMap.count(name) != 0)
-    return fTObjectIntIntMap[name][i][j];
+  if (slot != nullptr && slot->fValue != nullptr) {
+    if (slot->fType == kO)
+      return SlotValue<TObject*>(slot->fValue);
+    if (slot->fType == kIO)
+      return SlotValue<internal::DenseIndexMap<TObject*> >(slot->fValue)[i];
+    if (slot->fType == kIIO)
+      return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<TObject*> > >(slot->fValue)[i][j];
+  }
 
-  throw HALException(name.insert(0, "Error retrieving data: ").c_str());
+  throw HALException(key.GetName().Prepend("Error retrieving data: "));
+}
+
+//______________________________________________________________________________
+void AnalysisData::SetProvider (const DataKey &key, internal::ValueProvider *provider)
+{
+  if (!key.IsValid())
+    throw HALException("Can't set a value provider for an invalid key");
+  if (key.GetID() >= fProviders.size())
+    fProviders.resize(key.GetID() + 1, nullptr);
+  fProviders[key.GetID()] = provider;
 }
 
 //______________________________________________________________________________
 bool AnalysisData::Exists (const TString &name, const long long &i, 
                            const long long &j) 
 {
-  std::string n(name.Data());
+  return Exists(DataKey::Find(name), i, j);
+}
 
-  if (NameAlreadyStored(n) && i == -1 && j == -1)
+//______________________________________________________________________________
+bool AnalysisData::Exists (const DataKey &key, const long long &i, 
+                           const long long &j) 
+{
+  DataSlot *slot = FindSlot(key);
+
+  if (slot == nullptr)
+    return i == -1 && j == -1 && FindProvider(key) != nullptr;
+  if (i == -1 && j == -1)
     return true;
-  if (NameAlreadyStored(n) && j == -1) {
-    if (fNameTypeMap[n] == kIB)
-      return (fBoolIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kID)
-      return (fDecimalIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kII)
-      return (fIntegerIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIC)
-      return (fCountingIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIS)
-      return (fStringIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIO)
-      return (fTObjectIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIB)
-      return (fBoolIntIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIID)
-      return (fDecimalIntIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIII)
-      return (fIntegerIntIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIC)
-      return (fCountingIntIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIS)
-      return (fStringIntIntMap[n].count(i) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIO)
-      return (fTObjectIntIntMap[n].count(i) == 1) ? true : false;
+  if (slot->fValue == nullptr)
+    return false;
+  if (j == -1) {
+    switch (slot->fType) {
+      case kIB:  return SlotValue<internal::DenseIndexMap<bool> >(slot->fValue).count(i) == 1;
+      case kID:  return SlotValue<internal::DenseIndexMap<long double> >(slot->fValue).count(i) == 1;
+      case kII:  return SlotValue<internal::DenseIndexMap<long long> >(slot->fValue).count(i) == 1;
+      case kIC:  return SlotValue<internal::DenseIndexMap<unsigned long long> >(slot->fValue).count(i) == 1;
+      case kIS:  return SlotValue<internal::DenseIndexMap<std::string> >(slot->fValue).count(i) == 1;
+      case kIO:  return SlotValue<internal::DenseIndexMap<TObject*> >(slot->fValue).count(i) == 1;
+      case kIIB: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<bool> > >(slot->fValue).count(i) == 1;
+      case kIID: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long double> > >(slot->fValue).count(i) == 1;
+      case kIII: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long long> > >(slot->fValue).count(i) == 1;
+      case kIIC: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > >(slot->fValue).count(i) == 1;
+      case kIIS: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<std::string> > >(slot->fValue).count(i) == 1;
+      case kIIO: return SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<TObject*> > >(slot->fValue).count(i) == 1;
+      default:   return false;
+    }
   }
-  if (NameAlreadyStored(n)) {
-    if (fNameTypeMap[n] == kIIB)
-      return (fBoolIntIntMap[n][i].count(j) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIID)
-      return (fDecimalIntIntMap[n][i].count(j) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIII)
-      return (fIntegerIntIntMap[n][i].count(j) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIC)
-      return (fCountingIntIntMap[n][i].count(j) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIS)
-      return (fStringIntIntMap[n][i].count(j) == 1) ? true : false;
-    if (fNameTypeMap[n] == kIIO)
-      return (fTObjectIntIntMap[n][i].count(j) == 1) ? true : false;
+  switch (slot->fType) {
+    case kIIB: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<bool> > >(slot->fValue), i, j);
+    case kIID: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long double> > >(slot->fValue), i, j);
+    case kIII: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long long> > >(slot->fValue), i, j);
+    case kIIC: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > >(slot->fValue), i, j);
+    case kIIS: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<std::string> > >(slot->fValue), i, j);
+    case kIIO: return InnerCount(SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<TObject*> > >(slot->fValue), i, j);
+    default:   return false;
   }
-  return false;
 }
 
 //______________________________________________________________________________
-unsigned AnalysisData::TypeDim (std::string n) 
+unsigned AnalysisData::StorageDim (StorageType type) 
 {
-  if (fNameTypeMap[n] == kB || fNameTypeMap[n] == kD ||
-      fNameTypeMap[n] == kI || fNameTypeMap[n] == kC ||
-      fNameTypeMap[n] == kS || fNameTypeMap[n] == kO)
+  if (type == kB || type == kD ||
+      type == kI || type == kC ||
+      type == kS || type == kO)
     return 0;
-  if (fNameTypeMap[n] == kIB || fNameTypeMap[n] == kID ||
-      fNameTypeMap[n] == kII || fNameTypeMap[n] == kIC ||
-      fNameTypeMap[n] == kIS || fNameTypeMap[n] == kIO)
+  if (type == kIB || type == kID ||
+      type == kII || type == kIC ||
+      type == kIS || type == kIO)
     return 1;
-  if (fNameTypeMap[n] == kIIB || fNameTypeMap[n] == kIID ||
-      fNameTypeMap[n] == kIII || fNameTypeMap[n] == kIIC ||
-      fNameTypeMap[n] == kIIS || fNameTypeMap[n] == kIIO)
+  if (type == kIIB || type == kIID ||
+      type == kIII || type == kIIC ||
+      type == kIIS || type == kIIO)
     return 2;
   throw HALException("Type dimension couldn't be determined.");
 }
 
+//______________________________________________________________________________
+unsigned AnalysisData::TypeDim (std::string n) 
+{
+  NameTypeMap::iterator it = fNameTypeMap.find(n);
+
+  if (it == fNameTypeMap.end())
+    throw HALException(n.insert(0, "Type dimension couldn't be determined for ").c_str());
+  return StorageDim(it->second);
+}
+
+//______________________________________________________________________________
+void AnalysisData::PrefixRange (const std::string &prefix, NameTypeMap::iterator &first, 
+                                NameTypeMap::iterator &last) 
+{
+  // every name starting with prefix sorts into [prefix, end of prefix range)
+  first = fNameTypeMap.lower_bound(prefix);
+  last = first;
+  while (last != fNameTypeMap.end() && 
+         last->first.compare(0, prefix.size(), prefix) == 0)
+    ++last;
+}
+
 //______________________________________________________________________________
 std::vector<TString> AnalysisData::GetSimilarNames (const TString &nn, 
                                                     unsigned min_dim) 
 {
   std::string n(nn.Data());
+  NameTypeMap::iterator first, last;
 
   std::vector<TString> names;
-  TRegexp pat(n.substr(0, n.find_first_of(':')).insert(0, "^").c_str()); // pick out ^<name>:
-
-#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, StorageType> it;
-  BOOST_FOREACH( it, fNameTypeMap )
-#else
-  for (auto it: fNameTypeMap)
-#endif
-  {
-    TString name(it.first.c_str());
-    if (name.Contains(pat) && TypeDim(it.first) >= min_dim && it.first != n)
-      names.push_back(it.first);
+  PrefixRange(n.substr(0, n.find_first_of(':')), first, last); // pick out <name>
+
+  for (NameTypeMap::iterator it = first; it != last; ++it) {
+    if (StorageDim(it->second) >= min_dim && it->first != n)
+      names.push_back(it->first.c_str());
   }
   
   return names;
@@ -527,51 +791,58 @@ std::vector<TString> AnalysisData::GetSimilarNames (const TString &nn,
 //______________________________________________________________________________
 void AnalysisData::CopyValues (const TString &f, const TString &t) 
 {
-  std::string from(f.Data());
-  std::string to(t.Data());
-
-  if (TypeDim(from) == 0) {
-    if (fNameTypeMap[from] == kB)
-      fBoolMap[to] = fBoolMap[from];
-    else if (fNameTypeMap[from] == kD)
-      fDecimalMap[to] = fDecimalMap[from];
-    else if (fNameTypeMap[from] == kI)
-      fIntegerMap[to] = fIntegerMap[from];
-    else if (fNameTypeMap[from] == kC)
-      fCountingMap[to] = fCountingMap[from];
-    else if (fNameTypeMap[from] == kS)
-      fStringMap[to] = fStringMap[from];
-    else if (fNameTypeMap[from] == kO)
-      fTObjectMap[to] = fTObjectMap[from];
-  }
-  else if (TypeDim(from) == 1) {
-    if (fNameTypeMap[from] == kIB)
-      fBoolIntMap[to] = fBoolIntMap[from];
-    else if (fNameTypeMap[from] == kID)
-      fDecimalIntMap[to] = fDecimalIntMap[from];
-    else if (fNameTypeMap[from] == kII)
-      fIntegerIntMap[to] = fIntegerIntMap[from];
-    else if (fNameTypeMap[from] == kIC)
-      fCountingIntMap[to] = fCountingIntMap[from];
-    else if (fNameTypeMap[from] == kIS)
-      fStringIntMap[to] = fStringIntMap[from];
-    else if (fNameTypeMap[from] == kIO)
-      fTObjectIntMap[to] = fTObjectIntMap[from];
-  }
-  else if (TypeDim(from) == 2) {
-    if (fNameTypeMap[from] == kIIB)
-      fBoolIntIntMap[to] = fBoolIntIntMap[from];
-    else if (fNameTypeMap[from] == kIID)
-      fDecimalIntIntMap[to] = fDecimalIntIntMap[from];
-    else if (fNameTypeMap[from] == kIII)
-      fIntegerIntIntMap[to] = fIntegerIntIntMap[from];
-    else if (fNameTypeMap[from] == kIIC)
-      fCountingIntIntMap[to] = fCountingIntIntMap[from];
-    else if (fNameTypeMap[from] == kIIS)
-      fStringIntIntMap[to] = fStringIntIntMap[from];
-    else if (fNameTypeMap[from] == kIIO)
-      fTObjectIntIntMap[to] = fTObjectIntIntMap[from];
-  }
+  DataKey to_key(t);
+  DataSlot &to = GetSlot(to_key);
+  DataSlot *from = ValueSlot(RetrievalKey(f));
+  std::string name(to_key.GetString());
+
+  // a provider that didn't supply its value leaves nothing to copy
+  if (from == nullptr)
+    throw HALException(TString(f).Prepend("Error retrieving data: "));
+
+  if (!to.fRegistered)
+    RegisterName(to_key, from->fType);
+  else if (to.fType != from->fType)
+    throw HALException(name.insert(0, "Cannot reassign storage container for ").c_str());
+  if (from->fValue == nullptr)
+    return;
+
+  if (from->fType == kB)
+    to.fValue = &(fScalarMap.access<bool>(to_key) = SlotValue<bool>(from->fValue));
+  else if (from->fType == kD)
+    to.fValue = &(fScalarMap.access<long double>(to_key) = SlotValue<long double>(from->fValue));
+  else if (from->fType == kI)
+    to.fValue = &(fScalarMap.access<long long>(to_key) = SlotValue<long long>(from->fValue));
+  else if (from->fType == kC)
+    to.fValue = &(fScalarMap.access<unsigned long long>(to_key) = SlotValue<unsigned long long>(from->fValue));
+  else if (from->fType == kS)
+    to.fValue = &(fScalarMap.access<std::string>(to_key) = SlotValue<std::string>(from->fValue));
+  else if (from->fType == kO)
+    to.fValue = &(fScalarMap.access<TObject*>(to_key) = SlotValue<TObject*>(from->fValue));
+  else if (from->fType == kIB)
+    to.fValue = &(fBoolIntMap[name] = SlotValue<internal::DenseIndexMap<bool> >(from->fValue));
+  else if (from->fType == kID)
+    to.fValue = &(fDecimalIntMap[name] = SlotValue<internal::DenseIndexMap<long double> >(from->fValue));
+  else if (from->fType == kII)
+    to.fValue = &(fIntegerIntMap[name] = SlotValue<internal::DenseIndexMap<long long> >(from->fValue));
+  else if (from->fType == kIC)
+    to.fValue = &(fCountingIntMap[name] = SlotValue<internal::DenseIndexMap<unsigned long long> >(from->fValue));
+  else if (from->fType == kIS)
+    to.fValue = &(fStringIntMap[name] = SlotValue<internal::DenseIndexMap<std::string> >(from->fValue));
+  else if (from->fType == kIO)
+    to.fValue = &(fTObjectIntMap[name] = SlotValue<internal::DenseIndexMap<TObject*> >(from->fValue));
+  else if (from->fType == kIIB)
+    to.fValue = &(fBoolIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<bool> > >(from->fValue));
+  else if (from->fType == kIID)
+    to.fValue = &(fDecimalIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long double> > >(from->fValue));
+  else if (from->fType == kIII)
+    to.fValue = &(fIntegerIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<long long> > >(from->fValue));
+  else if (from->fType == kIIC)
+    to.fValue = &(fCountingIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > >(from->fValue));
+  else if (from->fType == kIIS)
+    to.fValue = &(fStringIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<std::string> > >(from->fValue));
+  else if (from->fType == kIIO)
+    to.fValue = &(fTObjectIntIntMap[name] = SlotValue<internal::DenseIndexMap<internal::DenseIndexMap<TObject*> > >(from->fValue));
 }
 
 //______________________________________________________________________________
@@ -627,15 +898,22 @@ void AnalysisData::SwapValues (const TString &name, long long i, long long j)
   }
 }
 
+//______________________________________________________________________________
+size_t AnalysisData::GetNValues () const
+{
+  size_t n = 0;
+
+  for (std::vector<DataSlot>::const_iterator it = fSlots.begin(); it != fSlots.end(); ++it) {
+    if (it->fRegistered && it->fValue != nullptr)
+      ++n;
+  }
+  return n;
+}
+
 //______________________________________________________________________________
 void AnalysisData::Reset () 
 {
-  fBoolMap.clear();
-  fDecimalMap.clear();
-  fIntegerMap.clear();
-  fCountingMap.clear();
-  fStringMap.clear();
-  fTObjectMap.clear();
+  fScalarMap.clear();
   fBoolIntMap.clear();
   fDecimalIntMap.clear();
   fIntegerIntMap.clear();
@@ -649,87 +927,81 @@ void AnalysisData::Reset ()
   fStringIntIntMap.clear();
   fTObjectIntIntMap.clear();
   fNameTypeMap.clear();
+  fSlots.assign(fSlots.size(), DataSlot());
 }
 
 //______________________________________________________________________________
 void AnalysisData::RemoveNameAndData (const TString &name) 
 {
-  std::string n(name.Data());
+  DataSlot *slot = FindSlot(DataKey::Find(name));
 
+  if (slot == nullptr)
+    return;
   RemoveData(name);
-  fNameTypeMap.erase(n);
+  fNameTypeMap.erase(std::string(name.Data()));
+  *slot = DataSlot();
 }
 
 //______________________________________________________________________________
 void AnalysisData::RemoveData (const TString &name) 
 {
-  std::string n(name.Data());
+  RemoveData(DataKey::Find(name));
+}
+
+//______________________________________________________________________________
+void AnalysisData::RemoveData (const DataKey &key) 
+{
+  DataSlot *slot = FindSlot(key);
+
+  if (slot == nullptr)
+    return;
+  slot->fValue = nullptr;
+
+  if (slot->fType <= kO) {
+    fScalarMap.remove(key);
+    return;
+  }
+
+  const std::string &n = key.GetString();
 
-  if (fNameTypeMap[n] == kB)
-    fBoolMap.erase(n);
-  else if (fNameTypeMap[n] == kD)
-    fDecimalMap.erase(n);
-  else if (fNameTypeMap[n] == kI)
-    fIntegerMap.erase(n);
-  else if (fNameTypeMap[n] == kC)
-    fCountingMap.erase(n);
-  else if (fNameTypeMap[n] == kS)
-    fStringMap.erase(n);
-  else if (fNameTypeMap[n] == kO)
-    fTObjectMap.erase(n);
-  else if (fNameTypeMap[n] == kIB)
+  if (slot->fType == kIB)
     fBoolIntMap.erase(n);
-  else if (fNameTypeMap[n] == kID)
+  else if (slot->fType == kID)
     fDecimalIntMap.erase(n);
-  else if (fNameTypeMap[n] == kII)
+  else if (slot->fType == kII)
     fIntegerIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIC)
+  else if (slot->fType == kIC)
     fCountingIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIS)
+  else if (slot->fType == kIS)
     fStringIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIO)
+  else if (slot->fType == kIO)
     fTObjectIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIIB)
+  else if (slot->fType == kIIB)
     fBoolIntIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIID)
+  else if (slot->fType == kIID)
     fDecimalIntIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIII)
+  else if (slot->fType == kIII)
     fIntegerIntIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIIC)
+  else if (slot->fType == kIIC)
     fCountingIntIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIIS)
+  else if (slot->fType == kIIS)
     fStringIntIntMap.erase(n);
-  else if (fNameTypeMap[n] == kIIO)
+  else if (slot->fType == kIIO)
     fTObjectIntIntMap.erase(n);
 }
 
 //______________________________________________________________________________
 void AnalysisData::RemoveAllAssociatedData (const TString &nn) 
 {
-  std::string n(nn.Data());
+  NameTypeMap::iterator first, last;
+  PrefixRange(std::string(nn.Data()), first, last);
 
-  TRegexp prefix(TString::Format("^%s:*.*", n.c_str()));
+  // copy the names first since removing them invalidates the range
   std::vector<std::string> names;
-
-#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, StorageType> name;
-  BOOST_FOREACH( name, fNameTypeMap )
-#else
-  for (auto name: fNameTypeMap)
-#endif
-  {
-    if (TString(name.first.c_str()).Contains(prefix)) {
-      RemoveData(name.first);
-      names.push_back(name.first);
-    }
-  }
-#ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  BOOST_FOREACH( std::string name2, names )
-#else
-  for (auto name2: names)
-#endif
-    fNameTypeMap.erase(name2);
+  for (NameTypeMap::iterator it = first; it != last; ++it)
+    names.push_back(it->first);
+  for (std::vector<std::string>::iterator name = names.begin(); name != names.end(); ++name)
+    RemoveNameAndData(name->c_str());
 }
 
-} /*  HAL */ 
-
+} /*  HAL */
@@ -9,6 +9,7 @@
 #include <HAL/AnalysisData.h>
 #include <HAL/AnalysisTreeReader.h>
 #include <HAL/AnalysisTreeWriter.h>
+#include <HAL/EventArena.h>
 
 ClassImp(HAL::AnalysisSelector);
 
@@ -16,7 +17,7 @@ namespace HAL {
 
 //______________________________________________________________________________
 AnalysisSelector::AnalysisSelector (Algorithm *af, TTree*) : 
-  fMessagePeriod(0), fAnalysisFlow(af), fChain(nullptr)  
+  fMessagePeriod(0), fAnalysisFlow(af), fEventArena(nullptr), fChain(nullptr)  
 {
   fInput = new TList();
 }
@@ -100,11 +101,15 @@ void AnalysisSelector::SlaveBegin (TTree * /*tree*/)
   atw->SetTreeName(fOutputTreeName);
   atw->SetTreeDescription(fOutputTreeDescription);
 
+  fEventArena = new EventArena();
+
   fAnalysisFlow->AddData("RawData", atr);
   fAnalysisFlow->AddData("UserData", ad);
   fAnalysisFlow->AddData("UserOutput", atw);
+  fAnalysisFlow->AddData("EventArena", fEventArena);
 
   fAnalysisFlow->SlaveBeginAlgo(GetOption());
+  fAnalysisFlow->FuseAlgos();
 }
 
 //______________________________________________________________________________
@@ -138,6 +143,8 @@ Bool_t AnalysisSelector::Process (Long64_t entry)
 
   // Execute (and then implicitly clean) all algorithms
   fAnalysisFlow->ExecuteAlgo(GetOption());
+  // Release everything created for this event in one step
+  fEventArena->Reset();
 
   return kTRUE;
 }
@@ -149,12 +156,18 @@ void AnalysisSelector::SlaveTerminate ()
   // have been processed. When running with PROOF SlaveTerminate() is called
   // on each slave server.
 
+  // Algorithms may still use the shared data while they finish
+  fAnalysisFlow->SlaveTerminateAlgo(GetOption());
+
   // Delete user data
   fAnalysisFlow->DeleteData("UserData");
   // Delete raw data
   fAnalysisFlow->DeleteData("RawData");
+  // Report the arena and pool sizes, then delete the (already reset) event arena
+  fEventArena->Print();
+  fAnalysisFlow->DeleteData("EventArena");
+  fEventArena = nullptr;
 
-  fAnalysisFlow->SlaveTerminateAlgo(GetOption());
   static_cast<AnalysisTreeWriter*>(fAnalysisFlow->GetData("UserOutput"))->WriteData();
 }
 
@@ -12,6 +12,27 @@ ClassImp(HAL::AnalysisTreeReader);
 
 namespace HAL {
 
+namespace {
+
+// copies a column of another type into buffer
+template <class From, class To>
+const To* ConvertColumn (const From *first, const From *last, std::vector<To> &buffer, size_t &n)
+{
+  buffer.assign(first, last);
+  n = buffer.size();
+  return buffer.data();
+}
+
+template <class From, class To>
+const To* ConvertColumn (const std::vector<From> &column, std::vector<To> &buffer, size_t &n)
+{
+  buffer.assign(column.begin(), column.end());
+  n = buffer.size();
+  return buffer.data();
+}
+
+}
+
 // For ROOT 6 HAL uses TTreeReader
 //#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
 
@@ -568,6 +589,91 @@ TRefArray& AnalysisTreeReader::GetRefArray (const TString &branchname,
   throw HALException(GetFullBranchName( branchname ).Prepend("Couldn't find TRefArray data in branch: ").Data());
 }
 
+//______________________________________________________________________________
+const long double* AnalysisTreeReader::GetDecimalArray (const TString &branchname, size_t &n) 
+{
+  internal::BranchManager *branchmanager = nullptr;
+
+  branchmanager = GetBranchManager(branchname);
+  if (branchmanager == nullptr)
+    throw HALException(branchname.Copy().Prepend("Couldn't configure branch: ").Data());
+
+  Int_t index = branchmanager->GetStorageIndex();
+  std::vector<long double> &buffer = branchmanager->GetDecimalBuffer();
+
+  if (branchmanager->GetStorageType() == kD) {
+    n = 1;
+    return &fD[index];
+  }
+  if (branchmanager->GetStorageType() == kvD) {
+    n = fvD[index].size();
+    return fvD[index].data();
+  }
+  if (branchmanager->GetStorageType() == kI)
+    return ConvertColumn(&fI[index], &fI[index] + 1, buffer, n);
+  if (branchmanager->GetStorageType() == kvI)
+    return ConvertColumn(fvI[index], buffer, n);
+  if (branchmanager->GetStorageType() == kC)
+    return ConvertColumn(&fC[index], &fC[index] + 1, buffer, n);
+  if (branchmanager->GetStorageType() == kvC)
+    return ConvertColumn(fvC[index], buffer, n);
+  if (branchmanager->GetStorageType() == kB) {
+    bool value = fB[index];
+    return ConvertColumn(&value, &value + 1, buffer, n);
+  }
+  if (branchmanager->GetStorageType() == kvB)
+    return ConvertColumn(fvB[index], buffer, n);
+
+  throw HALException(GetFullBranchName( branchname ).Prepend("Couldn't find decimal number array in branch: ").Data());
+}
+
+//______________________________________________________________________________
+const long long* AnalysisTreeReader::GetIntegerArray (const TString &branchname, size_t &n) 
+{
+  internal::BranchManager *branchmanager = nullptr;
+
+  branchmanager = GetBranchManager(branchname);
+  if (branchmanager == nullptr)
+    throw HALException(branchname.Copy().Prepend("Couldn't configure branch: ").Data());
+
+  Int_t index = branchmanager->GetStorageIndex();
+  std::vector<long long> &buffer = branchmanager->GetIntegerBuffer();
+
+  if (branchmanager->GetStorageType() == kI) {
+    n = 1;
+    return &fI[index];
+  }
+  if (branchmanager->GetStorageType() == kvI) {
+    n = fvI[index].size();
+    return fvI[index].data();
+  }
+  if (branchmanager->GetStorageType() == kC)
+    return ConvertColumn(&fC[index], &fC[index] + 1, buffer, n);
+  if (branchmanager->GetStorageType() == kvC)
+    return ConvertColumn(fvC[index], buffer, n);
+  if (branchmanager->GetStorageType() == kD)
+    return ConvertColumn(&fD[index], &fD[index] + 1, buffer, n);
+  if (branchmanager->GetStorageType() == kvD)
+    return ConvertColumn(fvD[index], buffer, n);
+  if (branchmanager->GetStorageType() == kB) {
+    bool value = fB[index];
+    return ConvertColumn(&value, &value + 1, buffer, n);
+  }
+  if (branchmanager->GetStorageType() == kvB)
+    return ConvertColumn(fvB[index], buffer, n);
+  // special case of char as 8-bit data holder
+  if (branchmanager->GetStorageType() == kvS && fChar.count(branchmanager->GetScalarType()) != 0) {
+    const std::vector<TString> &chars = fvS[index];
+    buffer.resize(chars.size());
+    for (size_t i = 0; i < chars.size(); ++i)
+      buffer[i] = (signed char)chars[i].Data()[0];
+    n = buffer.size();
+    return buffer.data();
+  }
+
+  throw HALException(GetFullBranchName( branchname ).Prepend("Couldn't find integer number array in branch: ").Data());
+}
+
 //______________________________________________________________________________
 internal::BranchManager* AnalysisTreeReader::GetBranchManager (const TString &branchname) {
   internal::BranchManager *branchmanager = nullptr;
@@ -21,63 +21,134 @@ AnalysisTreeWriter::AnalysisTreeWriter (const TString &ofile) :
 }
 
 //______________________________________________________________________________
-void  AnalysisTreeWriter::SetValue (const TString &n, const bool &v) 
+AnalysisTreeWriter::~AnalysisTreeWriter () 
+{
+  for (std::vector<TObject*>::iterator it = fObjects.begin(); it != fObjects.end(); ++it)
+    delete *it;
+}
+
+//______________________________________________________________________________
+void AnalysisTreeWriter::AddObject (TObject *obj) 
+{
+  fObjects.push_back(obj);
+}
+
+//______________________________________________________________________________
+void AnalysisTreeWriter::RecordEntry (const TString &n) 
 {
   fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const TString &n, const bool &v) 
+{
+  SetValue(DataKey(n), v);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const bool &v, 
                                     const long long &i) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount, i);
+  SetValue(DataKey(n), v, i);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const long double &v) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount);
+  SetValue(DataKey(n), v);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const long double &v, 
                                     const long long &i) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount, i);
+  SetValue(DataKey(n), v, i);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const long long &v) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount);
+  SetValue(DataKey(n), v);
 }
 
 //______________________________________________________________________________
-void AnalysisTreeWriter::SetValue (const TString &n, const long long &v, 
-                                   const long long &i) 
+void  AnalysisTreeWriter::SetValue (const TString &n, const long long &v, 
+                                    const long long &i) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount, i);
+  SetValue(DataKey(n), v, i);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const unsigned long long &v) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount);
+  SetValue(DataKey(n), v);
 }
 
 //______________________________________________________________________________
 void  AnalysisTreeWriter::SetValue (const TString &n, const unsigned long long &v, 
                                     const long long &i) 
 {
-  fTreeIndicesMap[fBranchTreeMap[n].EqualTo("") ? fTreeName : fBranchTreeMap[n]].insert(fCount);
-  AnalysisData::SetValue(n, v, fCount, i);
+  SetValue(DataKey(n), v, i);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const bool &v) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const bool &v, 
+                                    const long long &i) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount, i);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const long double &v) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const long double &v, 
+                                    const long long &i) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount, i);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const long long &v) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const long long &v, 
+                                    const long long &i) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount, i);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const unsigned long long &v) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount);
+}
+
+//______________________________________________________________________________
+void  AnalysisTreeWriter::SetValue (const DataKey &k, const unsigned long long &v, 
+                                    const long long &i) 
+{
+  RecordEntry(k.GetName());
+  AnalysisData::SetValue(k, v, fCount, i);
 }
 
 //______________________________________________________________________________
@@ -98,10 +169,10 @@ void AnalysisTreeWriter::WriteData()
   
   // Loop over maps to record how many trees to create
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, bool> > pair_BIM;
+  std::pair<std::string, internal::DenseIndexMap<bool> > pair_BIM;
   BOOST_FOREACH( pair_BIM, fBoolIntMap )
 #else
-  for (auto pair_BIM: fBoolIntMap)
+  for (auto &pair_BIM: fBoolIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_BIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -112,10 +183,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, long double> > pair_DIM;
+  std::pair<std::string, internal::DenseIndexMap<long double> > pair_DIM;
   BOOST_FOREACH( pair_DIM, fDecimalIntMap )
 #else
-  for (auto pair_DIM: fDecimalIntMap)
+  for (auto &pair_DIM: fDecimalIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_DIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -126,10 +197,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, long long> > pair_IIM;
+  std::pair<std::string, internal::DenseIndexMap<long long> > pair_IIM;
   BOOST_FOREACH( pair_IIM, fIntegerIntMap )
 #else
-  for (auto pair_IIM: fIntegerIntMap)
+  for (auto &pair_IIM: fIntegerIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_IIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -140,10 +211,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, unsigned long long> > pair_CIM;
+  std::pair<std::string, internal::DenseIndexMap<unsigned long long> > pair_CIM;
   BOOST_FOREACH( pair_CIM, fCountingIntMap )
 #else
-  for (auto pair_CIM: fCountingIntMap)
+  for (auto &pair_CIM: fCountingIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_CIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -163,10 +234,10 @@ void AnalysisTreeWriter::WriteData()
     //}
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, std::map<long long, bool> > > pair_BIIM;
+  std::pair<std::string, internal::DenseIndexMap<internal::DenseIndexMap<bool> > > pair_BIIM;
   BOOST_FOREACH( pair_BIIM, fBoolIntIntMap )
 #else
-  for (auto pair_BIIM: fBoolIntIntMap)
+  for (auto &pair_BIIM: fBoolIntIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_BIIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -177,10 +248,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, std::map<long long, long double> > > pair_DIIM;
+  std::pair<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long double> > > pair_DIIM;
   BOOST_FOREACH( pair_DIIM, fDecimalIntIntMap )
 #else
-  for (auto pair_DIIM: fDecimalIntIntMap)
+  for (auto &pair_DIIM: fDecimalIntIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_DIIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -191,10 +262,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, std::map<long long, long long> > > pair_IIIM;
+  std::pair<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long long> > > pair_IIIM;
   BOOST_FOREACH( pair_IIIM, fIntegerIntIntMap )
 #else
-  for (auto pair_IIIM: fIntegerIntIntMap)
+  for (auto &pair_IIIM: fIntegerIntIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_IIIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -205,10 +276,10 @@ void AnalysisTreeWriter::WriteData()
     }
   }
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
-  std::pair<std::string, std::map<long long, std::map<long long, unsigned long long> > > pair_CIIM;
+  std::pair<std::string, internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> > > pair_CIIM;
   BOOST_FOREACH( pair_CIIM, fCountingIntIntMap )
 #else
-  for (auto pair_CIIM: fCountingIntIntMap)
+  for (auto &pair_CIIM: fCountingIntIntMap)
 #endif
   {
     TString treeName = fBranchTreeMap[pair_CIIM.first.c_str()].EqualTo("") ? fTreeName : 
@@ -224,7 +295,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_BIM, fBoolIntMap )
 #else
-  for (auto pair_BIM: fBoolIntMap)
+  for (auto &pair_BIM: fBoolIntMap)
 #endif
   {
     std::string bname = pair_BIM.first;
@@ -236,7 +307,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_DIM, fDecimalIntMap )
 #else
-  for (auto pair_DIM: fDecimalIntMap)
+  for (auto &pair_DIM: fDecimalIntMap)
 #endif
   {
     std::string bname = pair_DIM.first;
@@ -248,7 +319,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_IIM, fIntegerIntMap )
 #else
-  for (auto pair_IIM: fIntegerIntMap)
+  for (auto &pair_IIM: fIntegerIntMap)
 #endif
   {
     std::string bname = pair_IIM.first;
@@ -260,7 +331,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_CIM, fCountingIntMap )
 #else
-  for (auto pair_CIM: fCountingIntMap)
+  for (auto &pair_CIM: fCountingIntMap)
 #endif
   {
     std::string bname = pair_CIM.first;
@@ -272,7 +343,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_BIIM, fBoolIntIntMap )
 #else
-  for (auto pair_BIIM: fBoolIntIntMap)
+  for (auto &pair_BIIM: fBoolIntIntMap)
 #endif
   {
     std::string bname = pair_BIIM.first;
@@ -289,7 +360,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_DIIM, fDecimalIntIntMap )
 #else
-  for (auto pair_DIIM: fDecimalIntIntMap)
+  for (auto &pair_DIIM: fDecimalIntIntMap)
 #endif
   {
     std::string bname = pair_DIIM.first;
@@ -301,7 +372,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_IIIM, fIntegerIntIntMap )
 #else
-  for (auto pair_IIIM: fIntegerIntIntMap)
+  for (auto &pair_IIIM: fIntegerIntIntMap)
 #endif
   {
     std::string bname = pair_IIIM.first;
@@ -313,7 +384,7 @@ void AnalysisTreeWriter::WriteData()
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
   BOOST_FOREACH( pair_CIIM, fCountingIntIntMap )
 #else
-  for (auto pair_CIIM: fCountingIntIntMap)
+  for (auto &pair_CIIM: fCountingIntIntMap)
 #endif
   {
     std::string bname = pair_CIIM.first;
@@ -686,67 +757,71 @@ void AnalysisTreeWriter::WriteData()
 
   // actual loop to fill in the TTree
   for (long long i = 1; i <= fCount; ++i) {
-    for (std::map<std::string, std::map<long long, bool>, internal::string_cmp >::iterator outer = fBoolIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<bool>, internal::string_cmp >::iterator outer = fBoolIntMap.begin();
         outer != fBoolIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
       if (fTreeIndicesMap[tname].count(i) != 0) {
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i))
-          bBoolValues[bname] = GetBool(bname, i);
+        const bool *value = outer->second.find(i);
+        if (value != nullptr)
+          bBoolValues[bname] = *value;
         else // DEFAULT
           bBoolValues[bname] = false;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, long double>, internal::string_cmp >::iterator outer = fDecimalIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<long double>, internal::string_cmp >::iterator outer = fDecimalIntMap.begin();
         outer != fDecimalIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
       if (fTreeIndicesMap[tname].count(i) != 0) {
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i))
-          bDecimalValues[bname] = GetDecimal(bname, i);
+        const long double *value = outer->second.find(i);
+        if (value != nullptr)
+          bDecimalValues[bname] = *value;
         else // DEFAULT
           bDecimalValues[bname] = -536870912.0;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, long long>, internal::string_cmp >::iterator outer = fIntegerIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<long long>, internal::string_cmp >::iterator outer = fIntegerIntMap.begin();
         outer != fIntegerIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
       if (fTreeIndicesMap[tname].count(i) != 0) {
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i))
-          bIntegerValues[bname] = GetInteger(bname, i);
+        const long long *value = outer->second.find(i);
+        if (value != nullptr)
+          bIntegerValues[bname] = *value;
         else // DEFAULT
           bIntegerValues[bname] = -536870912;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, unsigned long long>, internal::string_cmp >::iterator outer = fCountingIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<unsigned long long>, internal::string_cmp >::iterator outer = fCountingIntMap.begin();
         outer != fCountingIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
       if (fTreeIndicesMap[tname].count(i) != 0) {
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i))
-          bCountingValues[bname] = GetCounting(bname, i);
+        const unsigned long long *value = outer->second.find(i);
+        if (value != nullptr)
+          bCountingValues[bname] = *value;
         else // DEFAULT
           bCountingValues[bname] = 536870912;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, std::map<long long, bool> >, internal::string_cmp >::iterator outer = fBoolIntIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<bool> >, internal::string_cmp >::iterator outer = fBoolIntIntMap.begin();
         outer != fBoolIntIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
@@ -754,17 +829,15 @@ void AnalysisTreeWriter::WriteData()
         std::vector<bool> temp;
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i)) {
-          for (std::map<long long, bool>::iterator it = outer->second[i].begin();
-               it != outer->second[i].end(); ++it)
-            temp.push_back(it->second);
-        }
+        const internal::DenseIndexMap<bool> *values = outer->second.find(i);
+        if (values != nullptr)
+          values->values(temp);
         bBoolIntValues[bname] = temp;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, std::map<long long, long double> >, internal::string_cmp >::iterator outer = fDecimalIntIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long double> >, internal::string_cmp >::iterator outer = fDecimalIntIntMap.begin();
         outer != fDecimalIntIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
@@ -772,17 +845,15 @@ void AnalysisTreeWriter::WriteData()
         std::vector<double> temp;
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i)) {
-          for (std::map<long long, long double>::iterator it = outer->second[i].begin();
-               it != outer->second[i].end(); ++it)
-            temp.push_back(it->second);
-        }
+        const internal::DenseIndexMap<long double> *values = outer->second.find(i);
+        if (values != nullptr)
+          values->values(temp);
         bDecimalIntValues[bname] = temp; 
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, std::map<long long, long long> >, internal::string_cmp >::iterator outer = fIntegerIntIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<long long> >, internal::string_cmp >::iterator outer = fIntegerIntIntMap.begin();
         outer != fIntegerIntIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
@@ -790,17 +861,15 @@ void AnalysisTreeWriter::WriteData()
         std::vector<long long> temp;
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i)) {
-          for (std::map<long long, long long>::iterator it = outer->second[i].begin();
-               it != outer->second[i].end(); ++it)
-            temp.push_back(it->second);
-        }
+        const internal::DenseIndexMap<long long> *values = outer->second.find(i);
+        if (values != nullptr)
+          values->values(temp);
         bIntegerIntValues[bname] = temp;
       }
       else
         trees[tname]->SetBranchStatus(bname.c_str(), 0);
     }
-    for (std::map<std::string, std::map<long long, std::map<long long, unsigned long long> >, internal::string_cmp >::iterator outer = fCountingIntIntMap.begin();
+    for (std::map<std::string, internal::DenseIndexMap<internal::DenseIndexMap<unsigned long long> >, internal::string_cmp >::iterator outer = fCountingIntIntMap.begin();
         outer != fCountingIntIntMap.end(); ++outer) {
       std::string bname = outer->first;
       TString tname = fBranchTreeMap[bname.c_str()].EqualTo("") ? fTreeName : fBranchTreeMap[bname.c_str()];
@@ -808,11 +877,9 @@ void AnalysisTreeWriter::WriteData()
         std::vector<unsigned long long> temp;
         fill[tname] = true;
         trees[tname]->SetBranchStatus(bname.c_str(), 1);
-        if (Exists(bname, i)) {
-          for (std::map<long long, unsigned long long>::iterator it = outer->second[i].begin();
-               it != outer->second[i].end(); ++it)
-            temp.push_back(it->second);
-        }
+        const internal::DenseIndexMap<unsigned long long> *values = outer->second.find(i);
+        if (values != nullptr)
+          values->values(temp);
         bCountingIntValues[bname] = temp;
       }
       else
@@ -835,6 +902,9 @@ void AnalysisTreeWriter::WriteData()
 
   for (std::map<TString, TTree*>::iterator it = trees.begin(); it != trees.end(); ++it)
     it->second->SetBranchStatus("*", kTRUE);
+  // objects added by the algorithms aren't attached to the file
+  for (std::vector<TObject*>::iterator it = fObjects.begin(); it != fObjects.end(); ++it)
+    (*it)->Write();
   f.Write();
   f.Close();
 }
@@ -8,35 +8,46 @@ namespace HAL
  * */
 internal::AugmentValueAlgo::AugmentValueAlgo (TString name, TString title, 
     TString input, TString attribute_name) : 
-  HAL::Algorithm(name, title), fInput(input), fAttributeLabel(attribute_name) {
+  HAL::Algorithm(name, title), fInput(input), fAttributeLabel(attribute_name), 
+  fInputKey(input), fAttributeKey(attribute_name), fOutput(nullptr) {
 }
 
 void  internal::AugmentValueAlgo::Exec (Option_t* /*option*/) {
   HAL::AnalysisTreeReader *tr = GetRawData();
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName(), true);
   HAL::GenericData *input_data = NULL;
 
-  data->SetValue(GetName(), gen_data);
+  if (fOutput == nullptr)
+    fOutput = new GenericData(GetName());
+  else
+    fOutput->Reset();
+
+  HAL::GenericData *gen_data = fOutput;
 
-  if (data->Exists(fInput)) 
-    input_data = (GenericData*)data->GetTObject(fInput);
+  data->SetValue(GetNameKey(), gen_data);
+
+  if (data->Exists(fInputKey)) 
+    input_data = (GenericData*)data->GetTObject(fInputKey);
   else
     return;
-
-  for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
-       particle != input_data->GetParticleEnd(); ++ particle) {
-    ParticlePtr p = new Particle(**particle);
-    StoreValue(tr, p, p->GetOriginIndex()); // must be origin index as this is branch index
-    gen_data->AddParticle(p);
-    p->SetOwner(GetName());
-    p->SetOwnerIndex(gen_data->GetNParticles() - 1);
+  gen_data->SetSource(input_data);
+  PrepareValues(tr, input_data);
+
+  // the particles are only referenced and the values go into an overlay
+  for (size_t i = 0; i < input_data->GetNParticles(); ++i) {
+    ParticlePtr particle = input_data->GetParticle(i);
+    long double value = 0.0;
+    gen_data->AddSelected(i);
+    // must be origin index as this is branch index
+    if (StoreValue(tr, particle, particle->GetOriginIndex(), value))
+      gen_data->SetAttribute(particle, fAttributeKey, value);
   }
   IncreaseCounter(gen_data->GetNParticles());
 }
 
 void internal::AugmentValueAlgo::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
+  if (fOutput != nullptr)
+    fOutput->Reset();
 }
 
 
@@ -53,87 +64,96 @@ void internal::AugmentValueAlgo::Clear (Option_t* /*option*/) {
  * Importing Algorithms
  * */
 
-void Algorithms::AttachAttribute::StoreValue (AnalysisTreeReader *tr, 
-                                               ParticlePtr particle, long long i) {
-  if (fUserValue)
-    particle->SetAttribute(fAttributeLabel, fValue);
-  if (fBranchValue)
-    particle->SetAttribute(fAttributeLabel, tr->GetDecimal(fBranchLabel, i));
+void Algorithms::AttachAttribute::PrepareValues (AnalysisTreeReader* /*tr*/, 
+                                                  GenericData *input_data) {
+  fNRankTables = 0;
+  if (!fPropertyValue || !(fPtRank || fMRank || fERank || fEtRank || fP3Rank))
+    return;
+
+  HAL::GenericData *rank_data = input_data;
+
+  if (fRefCompare) {
+    HAL::AnalysisData *data = GetUserData();
+    if (!data->Exists(fRefParticles))
+      return;
+    rank_data = (GenericData*)data->GetTObject(fRefParticles);
+  }
+
+  // mark the ranked particles in the rows of their owners
+  for (size_t i = 0; i < rank_data->GetNParticles(); ++i) {
+    ParticlePtr particle = rank_data->GetParticle(i);
+    GenericData *owner = particle->GetAttributeData();
+    if (owner == nullptr)
+      continue;
+    RankTable *table = FindRankTable(owner);
+    if (table == nullptr) {
+      if (fNRankTables == fRankTables.size())
+        fRankTables.push_back(RankTable());
+      table = &fRankTables[fNRankTables++];
+      table->fOwner = owner;
+      table->fRank.assign(owner->GetNParticles(), 0);
+    }
+    table->fRank[particle->GetAttributeRow()] = 1;
+  }
+
+  // one walk over each owner's (shared) sorted order numbers the marked rows
+  for (size_t t = 0; t < fNRankTables; ++t) {
+    RankTable &table = fRankTables[t];
+    const std::vector<size_t> &sorted = table.fOwner->GetSortedIndices(RankKinematic(), true);
+    long long count = 0;
+    for (size_t k = 0; k < sorted.size(); ++k) {
+      if (table.fRank[sorted[k]] != 0)
+        table.fRank[sorted[k]] = ++count;
+    }
+  }
+}
+
+Algorithms::AttachAttribute::RankTable* Algorithms::AttachAttribute::FindRankTable (const GenericData *owner) {
+  for (size_t t = 0; t < fNRankTables; ++t) {
+    if (fRankTables[t].fOwner == owner)
+      return &fRankTables[t];
+  }
+  return nullptr;
+}
+
+bool Algorithms::AttachAttribute::StoreValue (AnalysisTreeReader *tr, 
+                                               ParticlePtr particle, long long i, 
+                                               long double &value) {
+  bool stored = false;
+
+  if (fUserValue) {
+    value = fValue;
+    stored = true;
+  }
+  if (fBranchValue) {
+    value = tr->GetDecimal(fBranchLabel, i);
+    stored = true;
+  }
   if (fPropertyValue) {
     if (fPtRank || fMRank || fERank || fEtRank || fP3Rank) {
-      HAL::AnalysisData *data = GetUserData();
-      HAL::GenericData *owner_data = NULL;
-      HAL::GenericData *input_data = NULL;
-      TString   sort_tag;
-      long long norigin;
-
-      if (fPtRank) sort_tag = "4v_pt";
-      if (fMRank) sort_tag = "4v_m";
-      if (fERank) sort_tag = "4v_e";
-      if (fEtRank) sort_tag = "4v_et";
-      if (fP3Rank) sort_tag = "4v_p3";
-
-      // Need to look for actual owner for sorting purposes
-      owner_data = (GenericData*)data->GetTObject(particle->GetOwner());
-
-      norigin = owner_data->GetNParticles();
-
-      // Create sorted list for owner data
-      if (!owner_data->HasParticles(sort_tag)) {
-        HAL::ParticlePtrs sorted_particles;
-
-        for (unsigned j = 0; j < norigin; ++j) 
-          sorted_particles.push_back(owner_data->GetParticle(j));
-        Sort(sorted_particles);
-        owner_data->SetParticles(sort_tag, sorted_particles);
-      }
+      RankTable *table = FindRankTable(particle->GetAttributeData());
 
-      // loop over the sorted list
-      bool found = false;
-      ParticlePtrs sorted_list = owner_data->GetParticles(sort_tag);
-      long long origin_count = 0, input_count = 0;
-      long long owner_index = particle->GetOwnerIndex();
-      if (fRefCompare) input_data = (GenericData*)data->GetTObject(fRefParticles);
-      else input_data = (GenericData*)data->GetTObject(fInput);
-      for (ParticlePtrsIt sorted_particle = sorted_list.begin(); 
-           sorted_particle != sorted_list.end(); ++ sorted_particle) {
-        ++origin_count;
-        for (ParticlePtrsIt my_particle = input_data->GetParticleBegin(); 
-             my_particle != input_data->GetParticleEnd(); ++ my_particle) {
-          if (*sorted_particle == *my_particle) {
-            ++input_count;
-            if (*sorted_particle == owner_data->GetParticle(owner_index)) {
-              particle->SetAttribute(fAttributeLabel, input_count);
-              found = true;
-            }
-            break;
-          }
-        }
-        if (found) break;
+      if (table != nullptr && table->fRank[particle->GetAttributeRow()] != 0) {
+        value = table->fRank[particle->GetAttributeRow()];
+        stored = true;
       }
     }
   }
+  return stored;
 }
 
-bool Algorithms::AttachAttribute::operator() (ParticlePtr lhs, ParticlePtr rhs) {
-  TLorentzVector *lhs_vec = lhs->GetP();
-  TLorentzVector *rhs_vec = rhs->GetP();
-
+GenericParticle::Kinematic Algorithms::AttachAttribute::RankKinematic () {
   if (fPtRank)
-    return (lhs_vec->Pt() > rhs_vec->Pt());
+    return GenericParticle::kPt;
   if (fMRank)
-    return (lhs_vec->M() > rhs_vec->M());
+    return GenericParticle::kM;
   if (fERank)
-    return (lhs_vec->E() > rhs_vec->E());
+    return GenericParticle::kE;
   if (fEtRank)
-    return (lhs_vec->Et() > rhs_vec->Et());
+    return GenericParticle::kEt;
   if (fP3Rank)
-    return (lhs_vec->P() > rhs_vec->P());
+    return GenericParticle::kP3;
   throw HALException(GetName().Prepend("Couldn't determine sorting information: "));
 }
 
-void Algorithms::AttachAttribute::Sort (ParticlePtrs &sl) {
-  std::stable_sort(sl.begin(), sl.end(), *this);
-}
-
 } /* HAL */ 
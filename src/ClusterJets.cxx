@@ -0,0 +1,299 @@
+#include <HAL/Algorithms/ClusterJets.h>
+#include <HAL/ParticleCollection.h>
+#include <TMath.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace HAL
+{
+
+// rapidity given to particles with no transverse mass
+static const double kMaxRapidity = 1e5;
+
+/*
+ * Reconstruction Algorithms
+ * */
+
+Algorithms::ClusterJets::ClusterJets (TString name, TString title, TString input,
+                                      TString algorithm, double radius) :
+    Algorithm(name, title), fInputKey(input), fParentsKey("parents"),
+    fR(radius), fR2(radius * radius), fMinPt(0.0),
+    fNRap(0), fNPhi(0), fRapMin(0.0), fRapCell(0.0), fPhiCell(0.0) {
+  TString alg(algorithm);
+
+  alg.ToLower();
+  if (alg.EqualTo("anti-kt") || alg.EqualTo("antikt") || alg.EqualTo("akt"))
+    fP = -1;
+  else if (alg.EqualTo("kt"))
+    fP = 1;
+  else if (alg.EqualTo("cambridge") || alg.EqualTo("ca") || alg.EqualTo("c/a") ||
+           alg.EqualTo("cambridge/aachen"))
+    fP = 0;
+  else
+    throw HALException(algorithm.Prepend("Unknown jet algorithm: "));
+  if (!(radius > 0.0))
+    throw HALException(name.Prepend("Jet radius must be positive for "));
+}
+
+bool Algorithms::ClusterJets::PtGreater::operator() (size_t a, size_t b) const {
+  return (*fPx)[a] * (*fPx)[a] + (*fPy)[a] * (*fPy)[a] >
+         (*fPx)[b] * (*fPx)[b] + (*fPy)[b] * (*fPy)[b];
+}
+
+double Algorithms::ClusterJets::MomentumFactor (double pt2) const {
+  if (fP == 0)
+    return 1.0;
+  if (fP > 0)
+    return pt2;
+  return pt2 > 0.0 ? 1.0 / pt2 : DBL_MAX;
+}
+
+double Algorithms::ClusterJets::DeltaR2 (size_t j, size_t k) const {
+  double drap = fRap[j] - fRap[k];
+  double dphi = std::fabs(fPhi[j] - fPhi[k]);
+
+  if (dphi > TMath::Pi())
+    dphi = TMath::TwoPi() - dphi;
+  return drap * drap + dphi * dphi;
+}
+
+double Algorithms::ClusterJets::Distance (size_t j) const {
+  if (fNeighbour[j] < 0)
+    return fKt2p[j];
+  return std::min(fKt2p[j], fKt2p[fNeighbour[j]]) * fNeighbourDist[j] / fR2;
+}
+
+long Algorithms::ClusterJets::TileOf (double rap, double phi) const {
+  double irap = std::floor((rap - fRapMin) / fRapCell);
+  long iphi = (long)std::floor(phi / fPhiCell);
+
+  // clamping keeps tiles that are within R of each other adjacent
+  if (irap < 0.0) irap = 0.0;
+  if (irap > fNRap - 1.0) irap = fNRap - 1.0;
+  if (iphi < 0) iphi = 0;
+  if (iphi >= fNPhi) iphi = fNPhi - 1;
+  return (long)irap * fNPhi + iphi;
+}
+
+void Algorithms::ClusterJets::AddToTile (size_t j) {
+  long tile = TileOf(fRap[j], fPhi[j]);
+
+  fTile[j] = tile;
+  fTilePrev[j] = -1;
+  fTileNext[j] = fTileHead[tile];
+  if (fTileHead[tile] >= 0)
+    fTilePrev[fTileHead[tile]] = j;
+  fTileHead[tile] = j;
+}
+
+void Algorithms::ClusterJets::RemoveFromTile (size_t j) {
+  if (fTilePrev[j] >= 0)
+    fTileNext[fTilePrev[j]] = fTileNext[j];
+  else
+    fTileHead[fTile[j]] = fTileNext[j];
+  if (fTileNext[j] >= 0)
+    fTilePrev[fTileNext[j]] = fTilePrev[j];
+}
+
+void Algorithms::ClusterJets::FindNeighbour (size_t j) {
+  long irap = fTile[j] / fNPhi, iphi = fTile[j] % fNPhi;
+  long rap_low = irap > 0 ? irap - 1 : 0;
+  long rap_high = irap + 1 < fNRap ? irap + 1 : fNRap - 1;
+  // with fewer than three phi tiles every tile is a neighbour
+  long nphi = fNPhi < 3 ? fNPhi : 3;
+  long phi_low = fNPhi < 3 ? 0 : iphi - 1;
+
+  fNeighbour[j] = -1;
+  fNeighbourDist[j] = fR2;
+  for (long r = rap_low; r <= rap_high; ++r) {
+    for (long k = 0; k < nphi; ++k) {
+      long tile = r * fNPhi + (phi_low + k + fNPhi) % fNPhi;
+      for (long other = fTileHead[tile]; other >= 0; other = fTileNext[other]) {
+        if ((size_t)other == j)
+          continue;
+        double dist = DeltaR2(j, other);
+        if (dist < fNeighbourDist[j]) {
+          fNeighbourDist[j] = dist;
+          fNeighbour[j] = other;
+        }
+      }
+    }
+  }
+}
+
+void Algorithms::ClusterJets::SetKinematics (size_t j) {
+  double pt2 = fPx[j] * fPx[j] + fPy[j] * fPy[j];
+
+  if (fE[j] > std::fabs(fPz[j]))
+    fRap[j] = 0.5 * std::log((fE[j] + fPz[j]) / (fE[j] - fPz[j]));
+  else
+    fRap[j] = fPz[j] >= 0.0 ? kMaxRapidity : -kMaxRapidity;
+  fPhi[j] = pt2 > 0.0 ? std::atan2(fPy[j], fPx[j]) : 0.0;
+  if (fPhi[j] < 0.0)
+    fPhi[j] += TMath::TwoPi();
+  fKt2p[j] = MomentumFactor(pt2);
+}
+
+void Algorithms::ClusterJets::Exec (Option_t* /*option*/) {
+  HAL::AnalysisData *data = GetUserData();
+  HAL::EventArena *arena = GetEventArena();
+  HAL::GenericData *gen_data = arena->New<GenericData>(GetName(), true);
+  HAL::GenericData *input_data = NULL;
+
+  data->SetValue(GetNameKey(), gen_data);
+
+  if (data->Exists(fInputKey))
+    input_data = (GenericData*)data->GetTObject(fInputKey);
+  else
+    return;
+
+  const ParticleCollection &particles = input_data->GetCollection();
+  const double *px = particles.GetPx(), *py = particles.GetPy(),
+               *pz = particles.GetPz(), *e = particles.GetE();
+  const float *charge = particles.GetCharge();
+  size_t n = particles.GetSize();
+
+  /*
+   * Every input particle starts as a jet of its own
+   * */
+  fPx.resize(n); fPy.resize(n); fPz.resize(n); fE.resize(n);
+  fRap.resize(n); fPhi.resize(n); fKt2p.resize(n);
+  fNeighbour.resize(n); fNeighbourDist.resize(n);
+  fActivePos.resize(n);
+  fFirst.resize(n); fNext.resize(n); fLast.resize(n);
+  fTile.resize(n); fTilePrev.resize(n); fTileNext.resize(n);
+  fActive.clear();
+  fFinished.clear();
+
+  double rap_max = 0.0;
+  size_t ntiled = 0;
+
+  fRapMin = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(px[i]) || !std::isfinite(py[i]) ||
+        !std::isfinite(pz[i]) || !std::isfinite(e[i]))
+      continue;
+    fPx[i] = px[i];
+    fPy[i] = py[i];
+    fPz[i] = pz[i];
+    fE[i] = e[i];
+    SetKinematics(i);
+    fFirst[i] = fLast[i] = i;
+    fNext[i] = -1;
+    fActivePos[i] = fActive.size();
+    fActive.push_back(i);
+    if (std::fabs(fRap[i]) < kMaxRapidity) {
+      if (ntiled == 0 || fRap[i] < fRapMin) fRapMin = fRap[i];
+      if (ntiled == 0 || fRap[i] > rap_max) rap_max = fRap[i];
+      ++ntiled;
+    }
+  }
+
+  /*
+   * Tiles are at least R wide, so a jet's neighbours within R are in the
+   * tiles around it, and there are at most about four tiles per particle
+   * */
+  long budget = 4 * (long)fActive.size() + 16;
+  double nphi = std::floor(TMath::TwoPi() / fR);
+  fNPhi = nphi < 1.0 ? 1 : (nphi > budget ? budget : (long)nphi);
+  fPhiCell = TMath::TwoPi() / fNPhi;
+
+  double range = rap_max - fRapMin;
+  double nrap = std::floor(range / fR) + 1.0;
+  long max_rap = budget / fNPhi > 1 ? budget / fNPhi : 1;
+  fNRap = nrap > max_rap ? max_rap : (long)nrap;
+  fRapCell = range / fNRap > fR ? range / fNRap : fR;
+
+  fTileHead.assign(fNRap * fNPhi, -1);
+  for (std::vector<size_t>::iterator j = fActive.begin(); j != fActive.end(); ++j)
+    AddToTile(*j);
+  for (std::vector<size_t>::iterator j = fActive.begin(); j != fActive.end(); ++j)
+    FindNeighbour(*j);
+
+  /*
+   * Take the smallest distance: either merge the jet with its nearest
+   * neighbour or, if it is closest to the beam, the jet is finished
+   * */
+  while (!fActive.empty()) {
+    size_t a = fActive[0];
+    double dmin = Distance(a);
+    for (size_t k = 1; k < fActive.size(); ++k) {
+      double d = Distance(fActive[k]);
+      if (d < dmin) {
+        dmin = d;
+        a = fActive[k];
+      }
+    }
+
+    long b = fNeighbour[a];
+    size_t last;
+    if (b < 0) {
+      fFinished.push_back(a);
+      RemoveFromTile(a);
+      last = fActive.back();
+      fActive[fActivePos[a]] = last;
+      fActivePos[last] = fActivePos[a];
+      fActive.pop_back();
+    }
+    else {
+      fPx[a] += fPx[b];
+      fPy[a] += fPy[b];
+      fPz[a] += fPz[b];
+      fE[a] += fE[b];
+      fNext[fLast[a]] = fFirst[b];
+      fLast[a] = fLast[b];
+      RemoveFromTile(b);
+      last = fActive.back();
+      fActive[fActivePos[b]] = last;
+      fActivePos[last] = fActivePos[b];
+      fActive.pop_back();
+
+      RemoveFromTile(a);
+      SetKinematics(a);
+      AddToTile(a);
+      FindNeighbour(a);
+    }
+
+    // jets that pointed at a or b look again, the others may now be closest to a
+    for (std::vector<size_t>::iterator k = fActive.begin(); k != fActive.end(); ++k) {
+      if (*k == a)
+        continue;
+      if (fNeighbour[*k] == (long)a || (b >= 0 && fNeighbour[*k] == b))
+        FindNeighbour(*k);
+      else if (b >= 0) {
+        double dist = DeltaR2(*k, a);
+        if (dist < fNeighbourDist[*k]) {
+          fNeighbourDist[*k] = dist;
+          fNeighbour[*k] = a;
+        }
+      }
+    }
+  }
+
+  // Make particles of the finished jets
+  std::stable_sort(fFinished.begin(), fFinished.end(), PtGreater(&fPx, &fPy));
+  for (std::vector<size_t>::iterator j = fFinished.begin(); j != fFinished.end(); ++j) {
+    if (fPx[*j] * fPx[*j] + fPy[*j] * fPy[*j] < fMinPt * fMinPt && fMinPt > 0.0)
+      break;
+
+    HAL::ParticlePtr new_particle = arena->NewParticle(GetName());
+    TLorentzVector *vec = arena->NewVector(fPx[*j], fPy[*j], fPz[*j], fE[*j]);
+    float jet_charge = 0.0;
+
+    fConstituents.clear();
+    for (long c = fFirst[*j]; c >= 0; c = fNext[c]) {
+      fConstituents.push_back(input_data->GetParticle(c));
+      jet_charge += charge[c];
+    }
+    new_particle->SetCharge(jet_charge);
+    new_particle->SetP(vec);
+    new_particle->SetParticles(fParentsKey, fConstituents);
+    gen_data->AddParticle(new_particle);
+    new_particle->SetOwnerIndex(gen_data->GetNParticles() - 1);
+    new_particle->SetOriginIndex(gen_data->GetNParticles() - 1);
+  }
+  gen_data->SetRefType("none");
+}
+
+} /* HAL */
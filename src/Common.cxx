@@ -0,0 +1,103 @@
+#include <HAL/Common.h>
+#include <HAL/Exceptions.h>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+const unsigned SymbolTable::kNoSymbol;
+
+//______________________________________________________________________________
+SymbolTable::SymbolTable () : fBuckets(256, 0)
+{
+}
+
+//______________________________________________________________________________
+SymbolTable& SymbolTable::Instance ()
+{
+  static SymbolTable table;
+  return table;
+}
+
+//______________________________________________________________________________
+unsigned SymbolTable::Intern (const char *name, unsigned length)
+{
+  return Instance().Lookup(name, length, true);
+}
+
+//______________________________________________________________________________
+unsigned SymbolTable::Find (const char *name, unsigned length)
+{
+  return Instance().Lookup(name, length, false);
+}
+
+//______________________________________________________________________________
+const std::string& SymbolTable::Name (unsigned id)
+{
+  SymbolTable &table = Instance();
+
+  if (id >= table.fNames.size())
+    throw HALException("Tried to retrieve the name of an unknown symbol");
+  return table.fNames[id];
+}
+
+//______________________________________________________________________________
+unsigned SymbolTable::Size ()
+{
+  return Instance().fNames.size();
+}
+
+//______________________________________________________________________________
+unsigned SymbolTable::Lookup (const char *name, unsigned length, bool insert)
+{
+  // 64-bit FNV-1a
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned i = 0; i < length; ++i) {
+    hash ^= (unsigned char)name[i];
+    hash *= 1099511628211ULL;
+  }
+
+  unsigned mask = fBuckets.size() - 1;
+  unsigned bucket = hash & mask;
+  while (fBuckets[bucket] != 0) {
+    unsigned id = fBuckets[bucket] - 1;
+    if (fHashes[id] == hash && fNames[id].size() == length &&
+        memcmp(fNames[id].data(), name, length) == 0)
+      return id;
+    bucket = (bucket + 1) & mask;
+  }
+
+  if (!insert)
+    return kNoSymbol;
+
+  unsigned id = fNames.size();
+  fNames.push_back(std::string(name, length));
+  fHashes.push_back(hash);
+  fBuckets[bucket] = id + 1;
+
+  // keep the load factor below one half
+  if (2 * fNames.size() > fBuckets.size())
+    Rehash(2 * fBuckets.size());
+
+  return id;
+}
+
+//______________________________________________________________________________
+void SymbolTable::Rehash (unsigned nbuckets)
+{
+  unsigned mask = nbuckets - 1;
+
+  fBuckets.assign(nbuckets, 0);
+  for (unsigned id = 0; id < fNames.size(); ++id) {
+    unsigned bucket = fHashes[id] & mask;
+    while (fBuckets[bucket] != 0)
+      bucket = (bucket + 1) & mask;
+    fBuckets[bucket] = id + 1;
+  }
+}
+
+} /* internal */
+
+} /* HAL */
@@ -1,15 +1,37 @@
 #include <HAL/Algorithms/Cut.h>
+#include <chrono>
 
 namespace HAL
 {
 
+namespace {
+
+// evaluations between two timings of the same cut
+const Long64_t kCostSamplePeriod = 16;
+// events between two revisions of the order
+const Long64_t kReorderPeriod = 1000;
+
+// value types that AnalysisData converts between
+bool IsNumberType (const TString &ref_type) {
+  return ref_type.EqualTo("integer") || ref_type.EqualTo("counting") || ref_type.EqualTo("decimal");
+}
+
+// orders cut indices by increasing score
+struct ScoreLess {
+  ScoreLess (const std::vector<double> &scores) : fScores(scores) {}
+  bool operator() (size_t a, size_t b) const {return fScores[a] < fScores[b];}
+  const std::vector<double> &fScores;
+};
+
+}
+
 /*
  * Cutting Algorithm
  * */
 
 Algorithms::Cut::Cut (TString name, TString title, TString logic, 
     long long length, ...) :
-  CutAlgorithm(name, title), fAnd(false), fOr(false) {
+  CutAlgorithm(name, title), fAnd(false), fOr(false), fNEvents(0) {
   va_list arguments;  // store the variable list of arguments
 
   if (logic.EqualTo("and", TString::kIgnoreCase))
@@ -114,6 +136,11 @@ Algorithms::Cut::Cut (TString name, TString title, TString logic,
     }
   }
   va_end(arguments); // cleans up the list
+
+  for (size_t i = 0; i < fAlgorithms.size(); ++i) {
+    fAlgorithms[i]->fKey = DataKey(fAlgorithms[i]->fName);
+    fOrder.push_back(i);
+  }
 }
 
 Algorithms::Cut::~Cut () {
@@ -125,17 +152,13 @@ Algorithms::Cut::~Cut () {
 
 void Algorithms::Cut::Exec (Option_t* /*option*/) {
   AnalysisData *data = GetUserData();
-  HAL::GenericData *input_data = NULL;
+
+  if (++fNEvents % kReorderPeriod == 0)
+    Reorder();
 
   if (fAnd) {
-    for (std::vector<internal::AlgoInfo*>::iterator it = fAlgorithms.begin();
-         it != fAlgorithms.end(); ++it) {
-      if (!data->Exists((*it)->fName)) {
-        Abort();
-        return;
-      }
-      input_data = (GenericData*)data->GetTObject((*it)->fName);
-      if (!(*it)->Eval(data, input_data)) {
+    for (std::vector<size_t>::iterator it = fOrder.begin(); it != fOrder.end(); ++it) {
+      if (!Test(data, fAlgorithms[*it])) {
         Abort();
         return;
       }
@@ -143,22 +166,106 @@ void Algorithms::Cut::Exec (Option_t* /*option*/) {
     Passed();
   }
   else if (fOr) {
-    for (std::vector<internal::AlgoInfo*>::iterator it = fAlgorithms.begin();
-         it != fAlgorithms.end(); ++it) {
-      if (data->Exists((*it)->fName)) {
-        input_data = (GenericData*)data->GetTObject((*it)->fName);
-        if ((*it)->Eval(data, input_data)) {
-          Passed();
-          return;
-        }
+    for (std::vector<size_t>::iterator it = fOrder.begin(); it != fOrder.end(); ++it) {
+      if (Test(data, fAlgorithms[*it])) {
+        Passed();
+        return;
       }
     }
     Abort();
   }
 }
 
+bool Algorithms::Cut::Reads (const TString &name) {
+  DataKey key = DataKey::Find(name);
+
+  for (std::vector<internal::AlgoInfo*>::iterator it = fAlgorithms.begin();
+      it != fAlgorithms.end(); ++it) {
+    if ((*it)->fKey == key)
+      return true;
+  }
+  return false;
+}
+
+/*
+ * A cut passes if its algorithm has stored something and the stored value
+ * satisfies the relation; every few calls the evaluation is timed. Value
+ * algorithms make their value available whenever they store their output, so
+ * the existence test is all that makes the result independent of the order
+ * */
+bool Algorithms::Cut::Test (AnalysisData *data, internal::AlgoInfo *info) {
+  bool sample = (info->fCalls % kCostSamplePeriod == 0);
+  std::chrono::steady_clock::time_point start;
+
+  if (sample)
+    start = std::chrono::steady_clock::now();
+
+  bool pass = false;
+
+  if (data->Exists(info->fKey)) {
+    GenericData *gen_data = (GenericData*)data->GetTObject(info->fKey);
+    if (!info->fChecked)
+      Check(info, gen_data);
+    pass = info->Eval(data, gen_data);
+  }
+
+  if (sample) {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    info->fCost += (elapsed - info->fCost) / ++info->fCostSamples;
+  }
+  ++info->fCalls;
+  if (pass)
+    ++info->fPasses;
+  return pass;
+}
+
+void Algorithms::Cut::Check (internal::AlgoInfo *info, GenericData *gen_data) {
+  TString type = gen_data->GetRefType();
+
+  if (!info->Accepts(type))
+    throw HAL::HALException(TString::Format("Cut %s can't compare %s: it stores %s values", 
+                                            GetName().Data(), info->fName, 
+                                            type.Length() > 0 ? type.Data() : "no"));
+  info->fChecked = true;
+}
+
+/*
+ * For independent cuts the expected cost of "and" is smallest when they are
+ * sorted by cost / P(fail), and that of "or" when sorted by cost / P(pass)
+ * */
+void Algorithms::Cut::Reorder () {
+  std::vector<double> scores(fAlgorithms.size(), 0.0);
+
+  for (size_t i = 0; i < fAlgorithms.size(); ++i) {
+    internal::AlgoInfo *info = fAlgorithms[i];
+    // rates are smoothed so cuts that are rarely reached keep a finite score
+    double pass_rate = (info->fPasses + 1.0) / (info->fCalls + 2.0);
+    double decisive = fAnd ? 1.0 - pass_rate : pass_rate;
+    scores[i] = info->fCost / decisive;
+  }
+  std::stable_sort(fOrder.begin(), fOrder.end(), ScoreLess(scores));
+}
+
+Algorithms::CutExpression::CutExpression (TString name, TString title, TString expression) :
+  CutAlgorithm(name, title) {
+  fExpression.Compile(expression);
+  if (fExpression.IsParticleLevel())
+    throw HAL::HALException(GetName().Prepend("Event cut uses particle properties: "));
+}
+
+void Algorithms::CutExpression::Exec (Option_t* /*option*/) {
+  if (fExpression.Evaluate(GetUserData()))
+    Passed();
+  else
+    Abort();
+}
+
+bool  internal::BoolAlgoInfo::Accepts (const TString &ref_type) {
+  return ref_type.EqualTo("bool");
+}
+
 bool  internal::BoolAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData *gen_data) {
-  bool current_value = data->GetBool(gen_data->GetRefName());
+  bool current_value = data->GetBool(gen_data->GetRefKey());
 
   if (fEqual && current_value == fValue)
     return true;
@@ -167,8 +274,12 @@ bool  internal::BoolAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData *g
   return false;
 }
 
+bool  internal::IntegerAlgoInfo::Accepts (const TString &ref_type) {
+  return IsNumberType(ref_type);
+}
+
 bool  internal::IntegerAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData *gen_data) {
-  long long current_value = data->GetInteger(gen_data->GetRefName());
+  long long current_value = data->GetInteger(gen_data->GetRefKey());
 
   if (fEqual && current_value == fValue)
     return true;
@@ -185,8 +296,12 @@ bool  internal::IntegerAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData
   return false;
 }
 
+bool  internal::CountingAlgoInfo::Accepts (const TString &ref_type) {
+  return IsNumberType(ref_type);
+}
+
 bool  internal::CountingAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData *gen_data) {
-  unsigned long long current_value = data->GetCounting(gen_data->GetRefName());
+  unsigned long long current_value = data->GetCounting(gen_data->GetRefKey());
 
   if (fEqual && current_value == fValue)
     return true;
@@ -203,8 +318,12 @@ bool  internal::CountingAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericDat
   return false;
 }
 
+bool  internal::DecimalAlgoInfo::Accepts (const TString &ref_type) {
+  return IsNumberType(ref_type);
+}
+
 bool  internal::DecimalAlgoInfo::Eval (HAL::AnalysisData *data, HAL::GenericData *gen_data) {
-  long double current_value = data->GetDecimal(gen_data->GetRefName());
+  long double current_value = data->GetDecimal(gen_data->GetRefKey());
 
   if (fEqual && current_value == fValue)
     return true;
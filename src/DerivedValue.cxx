@@ -0,0 +1,79 @@
+#include <HAL/Algorithms/DerivedValue.h>
+#include <HAL/ParticleCollection.h>
+
+namespace HAL
+{
+
+/*
+ * Deriving Algorithms
+ * */
+
+Algorithms::ScalarSumPt::ScalarSumPt (TString name, TString title, long long length, ...) :
+  DerivedValueAlgo<long double>(name, title) {
+  va_list arguments;  // store the variable list of arguments
+
+  va_start (arguments, length); // initializing arguments to store all values after length
+  for (long long i = 0; i < length; ++i)
+    fInputKeys.push_back(DataKey(va_arg(arguments, const char*)));
+  va_end(arguments); // cleans up the list
+}
+
+long double Algorithms::ScalarSumPt::Compute () {
+  HAL::AnalysisData *data = GetUserData();
+  long double sum = 0.0;
+
+  for (std::vector<DataKey>::iterator key = fInputKeys.begin(); key != fInputKeys.end(); ++key) {
+    if (!data->Exists(*key))
+      continue;
+
+    const ParticleCollection &particles = ((GenericData*)data->GetTObject(*key))->GetCollection();
+    const double *pt = particles.GetPt();
+
+    for (size_t i = 0; i < particles.GetSize(); ++i)
+      sum += pt[i];
+  }
+  return sum;
+}
+
+bool Algorithms::ScalarSumPt::Reads (const TString &name) {
+  DataKey key = DataKey::Find(name);
+
+  for (std::vector<DataKey>::iterator input = fInputKeys.begin(); input != fInputKeys.end(); ++input) {
+    if (*input == key)
+      return true;
+  }
+  return false;
+}
+
+Algorithms::CountParticles::CountParticles (TString name, TString title, long long length, ...) :
+  DerivedValueAlgo<unsigned long long>(name, title) {
+  va_list arguments;  // store the variable list of arguments
+
+  va_start (arguments, length); // initializing arguments to store all values after length
+  for (long long i = 0; i < length; ++i)
+    fInputKeys.push_back(DataKey(va_arg(arguments, const char*)));
+  va_end(arguments); // cleans up the list
+}
+
+unsigned long long Algorithms::CountParticles::Compute () {
+  HAL::AnalysisData *data = GetUserData();
+  unsigned long long count = 0;
+
+  for (std::vector<DataKey>::iterator key = fInputKeys.begin(); key != fInputKeys.end(); ++key) {
+    if (data->Exists(*key))
+      count += ((GenericData*)data->GetTObject(*key))->GetNParticles();
+  }
+  return count;
+}
+
+bool Algorithms::CountParticles::Reads (const TString &name) {
+  DataKey key = DataKey::Find(name);
+
+  for (std::vector<DataKey>::iterator input = fInputKeys.begin(); input != fInputKeys.end(); ++input) {
+    if (*input == key)
+      return true;
+  }
+  return false;
+}
+
+} /* HAL */
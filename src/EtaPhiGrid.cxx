@@ -0,0 +1,121 @@
+#include <HAL/EtaPhiGrid.h>
+#include <cmath>
+#include <TMath.h>
+#include <TVector2.h>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+//______________________________________________________________________________
+void EtaPhiGrid::Build (const double *eta, const double *phi, size_t n, double radius)
+{
+  double eta_max = 0.0;
+  size_t nbinned = 0;
+
+  fNPoints = n;
+  fUnbinned.clear();
+  fEtaMin = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(eta[i]) || !std::isfinite(phi[i]))
+      continue;
+    if (nbinned == 0 || eta[i] < fEtaMin) fEtaMin = eta[i];
+    if (nbinned == 0 || eta[i] > eta_max) eta_max = eta[i];
+    ++nbinned;
+  }
+
+  // cells are never narrower than the radius and there are at most about
+  // four of them per point
+  long budget = 4 * (long)nbinned + 16;
+  double nphi = std::floor(TMath::TwoPi() / radius);
+  fNPhi = nphi < 1.0 ? 1 : (nphi > budget ? budget : (long)nphi);
+  fPhiCell = TMath::TwoPi() / fNPhi;
+
+  double range = eta_max - fEtaMin;
+  double neta = std::floor(range / radius) + 1.0;
+  long max_eta = budget / fNPhi > 1 ? budget / fNPhi : 1;
+  fNEta = neta > max_eta ? max_eta : (long)neta;
+  fEtaCell = range / fNEta > radius ? range / fNEta : radius;
+
+  // counting sort of the points into their cells
+  fCellStart.assign(fNEta * fNPhi + 1, 0);
+  fCell.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (!std::isfinite(eta[i]) || !std::isfinite(phi[i])) {
+      fCell[i] = -1;
+      fUnbinned.push_back(i);
+      continue;
+    }
+    long ieta = EtaCell(eta[i]);
+    if (ieta >= fNEta) ieta = fNEta - 1;
+    fCell[i] = ieta * fNPhi + PhiCell(phi[i]);
+    ++fCellStart[fCell[i] + 1];
+  }
+  for (size_t c = 1; c < fCellStart.size(); ++c)
+    fCellStart[c] += fCellStart[c - 1];
+  fEntries.resize(nbinned);
+  for (size_t i = 0; i < n; ++i) {
+    if (fCell[i] >= 0)
+      fEntries[fCellStart[fCell[i]]++] = i;
+  }
+  // the fill above advanced every start to the next cell's start
+  for (size_t c = fCellStart.size() - 1; c > 0; --c)
+    fCellStart[c] = fCellStart[c - 1];
+  fCellStart[0] = 0;
+}
+
+//______________________________________________________________________________
+void EtaPhiGrid::Neighbours (double eta, double phi, std::vector<size_t> &candidates) const
+{
+  candidates.clear();
+  if (!std::isfinite(eta) || !std::isfinite(phi)) {
+    for (size_t i = 0; i < fNPoints; ++i)
+      candidates.push_back(i);
+    return;
+  }
+
+  long ieta = EtaCell(eta);
+  long eta_low = ieta - 1 < 0 ? 0 : ieta - 1;
+  long eta_high = ieta + 1 >= fNEta ? fNEta - 1 : ieta + 1;
+  long iphi = PhiCell(phi);
+  // with fewer than three phi cells every cell is a neighbour
+  long nphi = fNPhi < 3 ? fNPhi : 3;
+  long phi_low = fNPhi < 3 ? 0 : iphi - 1;
+
+  for (long e = eta_low; e <= eta_high; ++e) {
+    for (long k = 0; k < nphi; ++k) {
+      long p = (phi_low + k + fNPhi) % fNPhi;
+      size_t cell = e * fNPhi + p;
+      for (size_t j = fCellStart[cell]; j < fCellStart[cell + 1]; ++j)
+        candidates.push_back(fEntries[j]);
+    }
+  }
+  candidates.insert(candidates.end(), fUnbinned.begin(), fUnbinned.end());
+}
+
+//______________________________________________________________________________
+long EtaPhiGrid::EtaCell (double eta) const
+{
+  double cell = std::floor((eta - fEtaMin) / fEtaCell);
+
+  // anything beyond the grid only needs to be told apart from its edges
+  if (cell < -2.0) return -2;
+  if (cell > fNEta + 1.0) return fNEta + 1;
+  return (long)cell;
+}
+
+//______________________________________________________________________________
+long EtaPhiGrid::PhiCell (double phi) const
+{
+  long cell = (long)std::floor((TVector2::Phi_mpi_pi(phi) + TMath::Pi()) / fPhiCell);
+
+  if (cell < 0) return 0;
+  if (cell >= fNPhi) return fNPhi - 1;
+  return cell;
+}
+
+} /* internal */
+
+} /* HAL */
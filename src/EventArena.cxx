@@ -0,0 +1,235 @@
+#include <HAL/EventArena.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <TLorentzVector.h>
+#include <HAL/Exceptions.h>
+
+ClassImp(HAL::EventArena);
+
+namespace HAL
+{
+
+namespace
+{
+
+// memory [begin, end) of the blocks and pool chunks of the arenas alive in
+// this process, sorted by begin (the ranges never overlap)
+typedef std::pair<const char*, const char*> Range;
+
+std::vector<Range>& LiveRanges ()
+{
+  static std::vector<Range> ranges;
+  return ranges;
+}
+
+bool BeginLess (const Range &range, const char *ptr) {return range.first < ptr;}
+bool BeginGreater (const char *ptr, const Range &range) {return ptr < range.first;}
+
+void Register (const void *memory, size_t size)
+{
+  std::vector<Range> &ranges = LiveRanges();
+  const char *begin = static_cast<const char*>(memory);
+
+  ranges.insert(std::lower_bound(ranges.begin(), ranges.end(), begin, BeginLess), 
+                Range(begin, begin + size));
+}
+
+void Unregister (const void *memory)
+{
+  std::vector<Range> &ranges = LiveRanges();
+  const char *begin = static_cast<const char*>(memory);
+  std::vector<Range>::iterator range = std::lower_bound(ranges.begin(), ranges.end(), begin, BeginLess);
+
+  if (range != ranges.end() && range->first == begin)
+    ranges.erase(range);
+}
+
+} /* anonymous */
+
+//______________________________________________________________________________
+EventArena::EventArena (size_t block_size) :
+  fBlockSize(block_size), fCurrent(0), fOffset(0), fHighWaterMark(0), 
+  fNParticleChunks(0), fNVectorChunks(0)
+{
+  if (fBlockSize == 0)
+    throw HALException("EventArena block size must be non-zero");
+}
+
+//______________________________________________________________________________
+EventArena::~EventArena ()
+{
+  Reset();
+  // particles must go first: their four-vectors live in the vector pool and
+  // are recognized (and not deleted) only while its chunks are registered
+  UnregisterChunks(fParticlePool);
+  fParticlePool.Release();
+  UnregisterChunks(fVectorPool);
+  fVectorPool.Release();
+  for (std::vector<Block>::iterator block = fBlocks.begin();
+       block != fBlocks.end(); ++block) {
+    Unregister(block->fData);
+    std::free(block->fData);
+  }
+}
+
+//______________________________________________________________________________
+bool EventArena::Contains (const void *ptr)
+{
+  const std::vector<Range> &ranges = LiveRanges();
+  const char *address = static_cast<const char*>(ptr);
+  // last range that begins at or before address
+  std::vector<Range>::const_iterator range = 
+    std::upper_bound(ranges.begin(), ranges.end(), address, BeginGreater);
+
+  if (range == ranges.begin())
+    return false;
+  --range;
+  return address < range->second;
+}
+
+//______________________________________________________________________________
+template <class T>
+void EventArena::RegisterChunks (const internal::ObjectPool<T> &pool, size_t &nregistered)
+{
+  for (; nregistered < pool.GetNChunks(); ++nregistered)
+    Register(pool.GetChunk(nregistered), pool.GetChunkBytes());
+}
+
+//______________________________________________________________________________
+template <class T>
+void EventArena::UnregisterChunks (const internal::ObjectPool<T> &pool)
+{
+  for (size_t i = 0; i < pool.GetNChunks(); ++i)
+    Unregister(pool.GetChunk(i));
+}
+
+//______________________________________________________________________________
+void* EventArena::Allocate (size_t size, size_t alignment)
+{
+  // advance through the retained blocks until one has room
+  while (fCurrent < fBlocks.size()) {
+    Block &block = fBlocks[fCurrent];
+    size_t start = (fOffset + alignment - 1) & ~(alignment - 1);
+    if (start + size <= block.fSize) {
+      fOffset = start + size;
+      return block.fData + start;
+    }
+    ++fCurrent;
+    fOffset = 0;
+  }
+
+  // blocks come from malloc, so they are already maximally aligned
+  Block block;
+  block.fSize = std::max(fBlockSize, size);
+  block.fData = static_cast<char*>(std::malloc(block.fSize));
+  if (block.fData == nullptr)
+    throw std::bad_alloc();
+  fBlocks.push_back(block);
+  Register(block.fData, block.fSize);
+  fCurrent = fBlocks.size() - 1;
+  fOffset = size;
+  return block.fData;
+}
+
+//______________________________________________________________________________
+ParticlePtr EventArena::NewParticle (const TString &owner, const TString &origin, const TString &name)
+{
+  ParticlePtr particle = fParticlePool.Recycle();
+
+  if (particle == nullptr) {
+    particle = fParticlePool.Create(owner, origin, name);
+    RegisterChunks(fParticlePool, fNParticleChunks);
+    return particle;
+  }
+  particle->Reset(owner, origin, name);
+  return particle;
+}
+
+//______________________________________________________________________________
+ParticlePtr EventArena::CopyParticle (const GenericParticle &particle)
+{
+  ParticlePtr copy = fParticlePool.Recycle();
+
+  if (copy == nullptr) {
+    copy = fParticlePool.Create("");
+    RegisterChunks(fParticlePool, fNParticleChunks);
+  }
+  copy->Assign(particle, NewVector());
+  return copy;
+}
+
+//______________________________________________________________________________
+TLorentzVector* EventArena::NewVector ()
+{
+  return NewVector(0.0, 0.0, 0.0, 0.0);
+}
+
+//______________________________________________________________________________
+TLorentzVector* EventArena::NewVector (double px, double py, double pz, double e)
+{
+  TLorentzVector *vec = fVectorPool.Recycle();
+
+  if (vec == nullptr) {
+    vec = fVectorPool.Create(px, py, pz, e);
+    RegisterChunks(fVectorPool, fNVectorChunks);
+    return vec;
+  }
+  vec->SetPxPyPzE(px, py, pz, e);
+  return vec;
+}
+
+//______________________________________________________________________________
+void EventArena::Reset ()
+{
+  size_t used = GetBytesInUse();
+  if (used > fHighWaterMark)
+    fHighWaterMark = used;
+
+  // destroy in reverse order of construction
+  for (std::vector<std::pair<Destructor, void*> >::reverse_iterator it = fDestructors.rbegin();
+       it != fDestructors.rend(); ++it)
+    it->first(it->second);
+  fDestructors.clear();
+  fParticlePool.Reset();
+  fVectorPool.Reset();
+
+  fCurrent = 0;
+  fOffset = 0;
+}
+
+//______________________________________________________________________________
+size_t EventArena::GetBytesInUse () const
+{
+  size_t used = 0;
+
+  for (size_t i = 0; i < fCurrent && i < fBlocks.size(); ++i)
+    used += fBlocks[i].fSize;
+  return used + fOffset;
+}
+
+//______________________________________________________________________________
+size_t EventArena::GetBytesReserved () const
+{
+  size_t reserved = 0;
+
+  for (std::vector<Block>::const_iterator block = fBlocks.begin();
+       block != fBlocks.end(); ++block)
+    reserved += block->fSize;
+  return reserved;
+}
+
+//______________________________________________________________________________
+void EventArena::Print (Option_t* /*option*/) const
+{
+  std::cout << "Event Memory Summary:" << std::endl;
+  std::cout << "  arena blocks: " << GetNBlocks() << " (" << GetBytesReserved() 
+            << " bytes reserved, " << GetHighWaterMark() << " bytes peak per event)" << std::endl;
+  std::cout << "  pooled particles: " << fParticlePool.GetSize() << " (peak per event: " 
+            << fParticlePool.GetHighWaterMark() << ")" << std::endl;
+  std::cout << "  pooled four-vectors: " << fVectorPool.GetSize() << " (peak per event: " 
+            << fVectorPool.GetHighWaterMark() << ")" << std::endl;
+  std::cout << "End of Event Memory Summary" << std::endl << std::endl;
+}
+
+} /* HAL */
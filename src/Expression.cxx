@@ -0,0 +1,526 @@
+#include <HAL/Expression.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <TVector2.h>
+#include <HAL/AnalysisData.h>
+#include <HAL/Exceptions.h>
+#include <HAL/GenericData.h>
+#include <HAL/ParticleCollection.h>
+
+namespace HAL
+{
+
+namespace internal
+{
+
+namespace {
+
+std::string Lower (const std::string &s)
+{
+  std::string result(s);
+
+  for (size_t i = 0; i < result.size(); ++i)
+    result[i] = std::tolower(result[i]);
+  return result;
+}
+
+}
+
+//______________________________________________________________________________
+void Expression::Compile (const TString &text)
+{
+  fText = text;
+  fCode.clear();
+  fKeys.clear();
+  fLists.clear();
+  fDepth = 0;
+  fStackSize = 0;
+  fParticleLevel = false;
+  fSource = text.Data();
+  fPos = 0;
+
+  Next();
+  if (fToken == kEnd)
+    Fail("empty expression");
+  ParseOr();
+  if (fToken != kEnd)
+    Fail("unexpected text after the expression");
+  fSource.clear();
+}
+
+//______________________________________________________________________________
+bool Expression::Evaluate (AnalysisData *data, const ParticleCollection &particles,
+                           std::vector<char> &keep)
+{
+  size_t n = particles.GetSize();
+
+  keep.assign(n, 0);
+  if (n == 0)
+    return true;
+  if (!Run(data, &particles, n))
+    return false;
+
+  const double *result = fStack[0].data();
+  for (size_t i = 0; i < n; ++i)
+    keep[i] = (result[i] != 0.0);
+  return true;
+}
+
+//______________________________________________________________________________
+bool Expression::Evaluate (AnalysisData *data)
+{
+  if (fParticleLevel)
+    throw HALException(fText.Copy().Prepend("Expression needs a particle: "));
+  return Run(data, nullptr, 1) && fStack[0][0] != 0.0;
+}
+
+//______________________________________________________________________________
+void Expression::Next ()
+{
+  static const char *pairs[] = {"&&", "||", "==", "!=", "<=", ">=", nullptr};
+  static const char *singles = "<>+-*/!(){},|";
+
+  while (fPos < fSource.size() && std::isspace(fSource[fPos]))
+    ++fPos;
+  fTokenStart = fPos;
+  fTokenText.clear();
+  if (fPos >= fSource.size()) {
+    fToken = kEnd;
+    return;
+  }
+
+  char c = fSource[fPos];
+  if (std::isdigit(c) || (c == '.' && fPos + 1 < fSource.size() && std::isdigit(fSource[fPos + 1]))) {
+    const char *start = fSource.c_str() + fPos;
+    char *end = nullptr;
+    fTokenValue = std::strtod(start, &end);
+    fPos += end - start;
+    fTokenText.assign(start, end - start);
+    fToken = kNumber;
+    return;
+  }
+  if (std::isalpha(c) || c == '_') {
+    size_t start = fPos;
+    while (fPos < fSource.size() &&
+           (std::isalnum(fSource[fPos]) || fSource[fPos] == '_' || fSource[fPos] == '.'))
+      ++fPos;
+    fTokenText = fSource.substr(start, fPos - start);
+    fToken = kName;
+    return;
+  }
+  if (c == '"' || c == '\'') {
+    size_t end = fSource.find(c, fPos + 1);
+    if (end == std::string::npos)
+      Fail("unterminated name");
+    fTokenText = fSource.substr(fPos + 1, end - fPos - 1);
+    fPos = end + 1;
+    fToken = kString;
+    return;
+  }
+  for (const char **pair = pairs; *pair != nullptr; ++pair) {
+    if (fSource.compare(fPos, 2, *pair) == 0) {
+      fTokenText = *pair;
+      fPos += 2;
+      fToken = kSymbol;
+      return;
+    }
+  }
+  if (std::strchr(singles, c) != nullptr) {
+    fTokenText = c;
+    ++fPos;
+    fToken = kSymbol;
+    return;
+  }
+  Fail("unexpected character");
+}
+
+//______________________________________________________________________________
+bool Expression::Accept (const char *symbol)
+{
+  if (fToken != kSymbol || fTokenText != symbol)
+    return false;
+  Next();
+  return true;
+}
+
+//______________________________________________________________________________
+void Expression::Expect (const char *symbol)
+{
+  if (!Accept(symbol))
+    Fail(TString::Format("expected '%s'", symbol).Data());
+}
+
+//______________________________________________________________________________
+void Expression::Fail (const char *message, size_t position)
+{
+  throw HALException(TString::Format("Syntax error at position %lu of \"%s\": %s",
+                                     (unsigned long)position, fText.Data(), message));
+}
+
+//______________________________________________________________________________
+void Expression::ParseOr ()
+{
+  ParseAnd();
+  while (Accept("||")) {
+    ParseAnd();
+    Emit(kOr);
+  }
+}
+
+//______________________________________________________________________________
+void Expression::ParseAnd ()
+{
+  ParseComparison();
+  while (Accept("&&")) {
+    ParseComparison();
+    Emit(kAnd);
+  }
+}
+
+//______________________________________________________________________________
+void Expression::ParseComparison ()
+{
+  static const char *symbols[] = {"==", "!=", "<", ">", "<=", ">="};
+  static const OpCode codes[] = {kEqual, kNotEqual, kLess, kGreater, kLessEqual, kGreaterEqual};
+
+  ParseSum();
+  for (size_t i = 0; i < 6; ++i) {
+    if (Accept(symbols[i])) {
+      ParseSum();
+      Emit(codes[i]);
+      return;
+    }
+  }
+  if (fToken == kName && Lower(fTokenText) == "in") {
+    std::vector<double> values;
+
+    Next();
+    Expect("{");
+    do {
+      double sign = Accept("-") ? -1.0 : 1.0;
+      if (sign > 0.0) Accept("+");
+      if (fToken != kNumber)
+        Fail("expected a number in the list");
+      values.push_back(sign * fTokenValue);
+      Next();
+    } while (Accept(","));
+    Expect("}");
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    fLists.push_back(values);
+    Emit(kInList, fLists.size() - 1);
+  }
+}
+
+//______________________________________________________________________________
+void Expression::ParseSum ()
+{
+  ParseProduct();
+  while (true) {
+    if (Accept("+")) {
+      ParseProduct();
+      Emit(kAdd);
+    }
+    else if (Accept("-")) {
+      ParseProduct();
+      Emit(kSubtract);
+    }
+    else
+      return;
+  }
+}
+
+//______________________________________________________________________________
+void Expression::ParseProduct ()
+{
+  ParseUnary();
+  while (true) {
+    if (Accept("*")) {
+      ParseUnary();
+      Emit(kMultiply);
+    }
+    else if (Accept("/")) {
+      ParseUnary();
+      Emit(kDivide);
+    }
+    else
+      return;
+  }
+}
+
+//______________________________________________________________________________
+void Expression::ParseUnary ()
+{
+  if (Accept("-")) {
+    ParseUnary();
+    Emit(kNegate);
+  }
+  else if (Accept("!")) {
+    ParseUnary();
+    Emit(kNot);
+  }
+  else if (Accept("+"))
+    ParseUnary();
+  else
+    ParsePrimary();
+}
+
+//______________________________________________________________________________
+void Expression::ParsePrimary ()
+{
+  if (fToken == kNumber) {
+    Emit(kConstant, 0, fTokenValue);
+    Next();
+  }
+  else if (Accept("(")) {
+    ParseOr();
+    Expect(")");
+  }
+  else if (Accept("|")) {
+    ParseSum();
+    Expect("|");
+    Emit(kAbs);
+  }
+  else if (fToken == kName) {
+    std::string name = fTokenText;
+    size_t start = fTokenStart;
+    Next();
+    ParseTerm(name, start);
+  }
+  else
+    Fail("expected a value");
+}
+
+//______________________________________________________________________________
+void Expression::ParseTerm (const std::string &name, size_t start)
+{
+  std::string lower = Lower(name);
+
+  if (Accept("(")) {
+    if (lower == "abs") {
+      ParseOr();
+      Emit(kAbs);
+    }
+    else if (lower == "count")
+      Emit(kCount, ParseReference());
+    else if (lower == "mindr") {
+      Emit(kMinDeltaR, ParseReference());
+      fParticleLevel = true;
+    }
+    else if (lower == "value")
+      Emit(kValue, ParseReference());
+    else
+      Fail("unknown function", start);
+    Expect(")");
+    return;
+  }
+
+  if (lower == "in")
+    Fail("expected a value", start);
+  fParticleLevel = true;
+  if (lower == "pt")
+    Emit(kKinematic, GenericParticle::kPt);
+  else if (lower == "eta")
+    Emit(kKinematic, GenericParticle::kEta);
+  else if (lower == "phi")
+    Emit(kKinematic, GenericParticle::kPhi);
+  else if (lower == "m")
+    Emit(kKinematic, GenericParticle::kM);
+  else if (lower == "e")
+    Emit(kKinematic, GenericParticle::kE);
+  else if (lower == "et")
+    Emit(kKinematic, GenericParticle::kEt);
+  else if (lower == "p3")
+    Emit(kKinematic, GenericParticle::kP3);
+  else if (lower == "rapidity")
+    Emit(kKinematic, GenericParticle::kRapidity);
+  else if (lower == "id")
+    Emit(kID);
+  else if (lower == "charge")
+    Emit(kCharge);
+  else {
+    fKeys.push_back(DataKey(name.c_str()));
+    Emit(kAttribute, fKeys.size() - 1);
+  }
+}
+
+//______________________________________________________________________________
+size_t Expression::ParseReference ()
+{
+  if (fToken != kName && fToken != kString)
+    Fail("expected an algorithm name");
+  fKeys.push_back(DataKey(fTokenText.c_str()));
+  Next();
+  return fKeys.size() - 1;
+}
+
+//______________________________________________________________________________
+void Expression::Emit (OpCode code, size_t arg, double value)
+{
+  fCode.push_back(Instruction(code, arg, value));
+  if (code <= kValue)
+    ++fStackSize;
+  else if (code >= kAdd && code <= kOr)
+    --fStackSize;
+  if (fStackSize > fDepth)
+    fDepth = fStackSize;
+}
+
+//______________________________________________________________________________
+bool Expression::Run (AnalysisData *data, const ParticleCollection *particles, size_t n)
+{
+  size_t top = 0;
+
+  fStack.resize(fDepth);
+  for (std::vector<Instruction>::const_iterator instr = fCode.begin();
+       instr != fCode.end(); ++instr) {
+    if (instr->fCode <= kValue) {
+      fStack[top].resize(n);
+      if (!Load(*instr, data, particles, n, fStack[top].data()))
+        return false;
+      ++top;
+      continue;
+    }
+
+    double *x = fStack[top - 1].data();
+    if (instr->fCode == kNegate)
+      for (size_t i = 0; i < n; ++i) x[i] = -x[i];
+    else if (instr->fCode == kNot)
+      for (size_t i = 0; i < n; ++i) x[i] = (x[i] == 0.0);
+    else if (instr->fCode == kAbs)
+      for (size_t i = 0; i < n; ++i) x[i] = std::fabs(x[i]);
+    else if (instr->fCode == kInList) {
+      const std::vector<double> &list = fLists[instr->fArg];
+      for (size_t i = 0; i < n; ++i) {
+        std::vector<double>::const_iterator it = std::lower_bound(list.begin(), list.end(), x[i]);
+        x[i] = (it != list.end() && *it == x[i]);
+      }
+    }
+    else {
+      // binary operators leave their result in the left operand
+      double *a = fStack[top - 2].data();
+      const double *b = x;
+      switch (instr->fCode) {
+        case kAdd:          for (size_t i = 0; i < n; ++i) a[i] = a[i] + b[i]; break;
+        case kSubtract:     for (size_t i = 0; i < n; ++i) a[i] = a[i] - b[i]; break;
+        case kMultiply:     for (size_t i = 0; i < n; ++i) a[i] = a[i] * b[i]; break;
+        case kDivide:       for (size_t i = 0; i < n; ++i) a[i] = a[i] / b[i]; break;
+        case kEqual:        for (size_t i = 0; i < n; ++i) a[i] = (a[i] == b[i]); break;
+        case kNotEqual:     for (size_t i = 0; i < n; ++i) a[i] = (a[i] != b[i]); break;
+        case kLess:         for (size_t i = 0; i < n; ++i) a[i] = (a[i] < b[i]); break;
+        case kGreater:      for (size_t i = 0; i < n; ++i) a[i] = (a[i] > b[i]); break;
+        case kLessEqual:    for (size_t i = 0; i < n; ++i) a[i] = (a[i] <= b[i]); break;
+        case kGreaterEqual: for (size_t i = 0; i < n; ++i) a[i] = (a[i] >= b[i]); break;
+        case kAnd:          for (size_t i = 0; i < n; ++i) a[i] = ((a[i] != 0.0) & (b[i] != 0.0)); break;
+        case kOr:           for (size_t i = 0; i < n; ++i) a[i] = ((a[i] != 0.0) | (b[i] != 0.0)); break;
+        default:            break;
+      }
+      --top;
+    }
+  }
+  return true;
+}
+
+//______________________________________________________________________________
+bool Expression::Load (const Instruction &instr, AnalysisData *data,
+                       const ParticleCollection *particles, size_t n, double *out)
+{
+  const double *column = nullptr;
+
+  switch (instr.fCode) {
+    case kConstant:
+      std::fill(out, out + n, instr.fValue);
+      return true;
+
+    case kKinematic:
+      if (instr.fArg == GenericParticle::kPt) column = particles->GetPt();
+      else if (instr.fArg == GenericParticle::kEta) column = particles->GetEta();
+      else if (instr.fArg == GenericParticle::kPhi) column = particles->GetPhi();
+      else if (instr.fArg == GenericParticle::kM) column = particles->GetM();
+      else if (instr.fArg == GenericParticle::kE) column = particles->GetE();
+      if (column != nullptr)
+        std::copy(column, column + n, out);
+      else {
+        // no column for this quantity: read the particles' caches
+        for (size_t i = 0; i < n; ++i)
+          out[i] = particles->GetParticle(i)->GetKinematic((GenericParticle::Kinematic)instr.fArg);
+      }
+      return true;
+
+    case kID: {
+      const int *id = particles->GetID();
+      for (size_t i = 0; i < n; ++i) out[i] = id[i];
+      return true;
+    }
+
+    case kCharge: {
+      const float *charge = particles->GetCharge();
+      for (size_t i = 0; i < n; ++i) out[i] = charge[i];
+      return true;
+    }
+
+    case kAttribute:
+      if (!particles->GatherAttribute(fKeys[instr.fArg], fAttributeValues))
+        throw HALException(fKeys[instr.fArg].GetName().Prepend("Couldn't find attribute: "));
+      for (size_t i = 0; i < n; ++i) out[i] = (double)fAttributeValues[i];
+      return true;
+
+    case kCount: {
+      double count = 0.0;
+      if (data->Exists(fKeys[instr.fArg]))
+        count = ((GenericData*)data->GetTObject(fKeys[instr.fArg]))->GetNParticles();
+      std::fill(out, out + n, count);
+      return true;
+    }
+
+    case kMinDeltaR: {
+      std::fill(out, out + n, std::numeric_limits<double>::infinity());
+      if (!data->Exists(fKeys[instr.fArg]))
+        return true;
+      ParticleCollection &refs = ((GenericData*)data->GetTObject(fKeys[instr.fArg]))->GetCollection();
+      size_t nrefs = refs.GetSize();
+      if (nrefs == 0)
+        return true;
+      const double *eta = particles->GetEta(), *phi = particles->GetPhi();
+      const double *ref_eta = refs.GetEta(), *ref_phi = refs.GetPhi();
+      for (size_t i = 0; i < n; ++i) {
+        ParticlePtr particle = particles->GetParticle(i);
+        double best = out[i];
+        for (size_t j = 0; j < nrefs; ++j) {
+          if (refs.GetParticle(j) == particle)
+            continue;
+          double deta = eta[i] - ref_eta[j];
+          double dphi = TVector2::Phi_mpi_pi(phi[i] - ref_phi[j]);
+          double dr2 = deta * deta + dphi * dphi;
+          if (dr2 < best) best = dr2;
+        }
+        out[i] = std::sqrt(best);
+      }
+      return true;
+    }
+
+    case kValue: {
+      if (!data->Exists(fKeys[instr.fArg]))
+        return false;
+      GenericData *gen_data = (GenericData*)data->GetTObject(fKeys[instr.fArg]);
+      double value;
+      if (gen_data->GetRefType().EqualTo("bool"))
+        value = data->GetBool(gen_data->GetRefName());
+      else
+        value = (double)data->GetDecimal(gen_data->GetRefName());
+      std::fill(out, out + n, value);
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+} /* internal */
+
+} /* HAL */
@@ -1,35 +1,289 @@
 #include <HAL/GenericData.h>
+#include <algorithm>
+#include <HAL/EventArena.h>
+#include <HAL/Exceptions.h>
 
 ClassImp(HAL::GenericData);
 
 namespace HAL
 {
 
+namespace
+{
+
+// orders positions by the values at those positions
+class IndexCompare {
+public:
+  IndexCompare (const std::vector<double> &values, bool descending) : 
+    fValues(values), fDescending(descending) {}
+  bool operator() (size_t lhs, size_t rhs) const {
+    return fDescending ? fValues[lhs] > fValues[rhs] : fValues[lhs] < fValues[rhs];
+  }
+
+private:
+  const std::vector<double> &fValues;
+  bool                       fDescending;
+};
+
+} /* anonymous */
+
 HAL::GenericData::GenericData (const TString &name, bool is_owner) : 
-  fIsOwner(is_owner), fUserDataRefName(""), fUserDataRefType("") {
+  fIsOwner(is_owner), fUserDataRefName(""), fUserDataRefType(""), fCollectionValid(false), 
+  fCollectionGeneration(0), fSourceGeneration(0), fSource(nullptr) {
   fParticles.reserve(20);
   SetName(name.Data());
 }
 
 HAL::GenericData::GenericData (const GenericData &data) : 
-  TNamed() {
+  TNamed(), fIsOwner(!data.fParticles.empty()), fCollectionValid(false), 
+  fCollectionGeneration(0), fSourceGeneration(0), fSource(data.fSource) {
   fUserDataRefName = data.fUserDataRefName; 
   fUserDataRefType = data.fUserDataRefType; 
+  fUserDataRefKey = data.fUserDataRefKey; 
   fParticles.reserve(20);
   for (ParticlePtrsConstIt particle = data.fParticles.begin(); 
        particle != data.fParticles.end(); ++particle) {
-    fParticles.push_back(new Particle(*(*particle)));
+    AddParticle(new Particle(*(*particle)));
   }
-  if (fParticles.size() > 0)
-    fIsOwner = true;
   f1DParticles = data.f1DParticles;
 }
 
 HAL::GenericData::~GenericData () {
   if (fIsOwner) {
-    for (ParticlePtrsIt particle = GetParticleBegin(); particle != GetParticleEnd(); ++particle) 
-      delete (*particle);
+    // particles built in an EventArena are released by the arena
+    for (ParticlePtrsIt particle = GetParticleBegin(); particle != GetParticleEnd(); ++particle) {
+      if (!EventArena::Contains(*particle))
+        delete (*particle);
+    }
+  }
+}
+
+void HAL::GenericData::Reset () {
+  if (fIsOwner) {
+    for (ParticlePtrsIt particle = GetParticleBegin(); particle != GetParticleEnd(); ++particle) {
+      if (!EventArena::Contains(*particle))
+        delete (*particle);
+    }
+  }
+  fUserDataRefName = "";
+  fUserDataRefType = "";
+  fUserDataRefKey = DataKey();
+  fParticles.clear();
+  fSourceIndices.clear();
+  f1DParticles.clear();
+  fCollection.Clear();
+  fCollectionValid = false;
+  fAttributes.clear();
+  fSorted.clear();
+  fSource = nullptr;
+}
+
+void HAL::GenericData::Adopt (ParticlePtr particle) {
+  GenericData *previous = particle->GetAttributeData();
+  size_t previous_row = particle->GetAttributeRow();
+  size_t row = fParticles.size() - 1;
+
+  // attributes set while the particle had no owner move into the columns
+  if (previous == nullptr) {
+    std::map<TString, long double, internal::string_cmp> &attributes = particle->GetAttributes();
+    for (std::map<TString, long double, internal::string_cmp>::iterator it = attributes.begin(); 
+         it != attributes.end(); ++it)
+      SetAttribute(RegisterAttribute(DataKey(it->first)), row, it->second);
+    attributes.clear();
+  }
+  particle->SetAttributeData(this, row);
+  // carry over the attributes of a copied particle
+  if (previous == nullptr || previous == this)
+    return;
+  for (unsigned c = 0; c < previous->fAttributes.size(); ++c) {
+    if (previous->fAttributes[c].fOverlay == nullptr && previous->HasAttribute(c, previous_row))
+      SetAttribute(RegisterAttribute(previous->fAttributes[c].fKey), row, 
+                   previous->fAttributes[c].fValues[previous_row]);
+  }
+}
+
+unsigned HAL::GenericData::RegisterAttribute (const DataKey &key, const GenericData *overlay) {
+  int column = FindAttribute(key, overlay);
+
+  if (column >= 0)
+    return column;
+  // overlays of one name must be nested selections, where the nearest one
+  // wins; unrelated containers would make the particle's own value ambiguous
+  for (std::vector<AttributeColumn>::const_iterator c = fAttributes.begin(); 
+       c != fAttributes.end() && overlay != nullptr; ++c) {
+    if (c->fOverlay == nullptr || !(c->fKey == key))
+      continue;
+    bool nested = false;
+    for (const GenericData *data = overlay; data != nullptr && !nested; data = data->fSource)
+      nested = (data == c->fOverlay);
+    for (const GenericData *data = c->fOverlay; data != nullptr && !nested; data = data->fSource)
+      nested = (data == overlay);
+    if (!nested)
+      throw HALException(TString::Format("Attribute %s is already attached to the particles of %s by %s, so %s can't attach it too",
+                                         key.GetName().Data(), GetName(), c->fOverlay->GetName(), overlay->GetName()));
+  }
+  fAttributes.push_back(AttributeColumn());
+  fAttributes.back().fKey = key;
+  fAttributes.back().fOverlay = overlay;
+  return fAttributes.size() - 1;
+}
+
+void HAL::GenericData::SetAttribute (unsigned column, size_t row, const long double &value) {
+  AttributeColumn &attribute = fAttributes[column];
+
+  if (row >= attribute.fValues.size()) {
+    size_t n = row < fParticles.size() ? fParticles.size() : row + 1;
+    attribute.fValues.resize(n, 0.0);
+    attribute.fSet.resize(n, 0);
+  }
+  attribute.fValues[row] = value;
+  attribute.fSet[row] = 1;
+}
+
+bool HAL::GenericData::FindParticleAttribute (size_t row, const DataKey &key, long double &value) const {
+  int own = -1;
+
+  // overlays are registered in the order they were attached
+  for (size_t c = fAttributes.size(); c-- > 0;) {
+    if (!(fAttributes[c].fKey == key))
+      continue;
+    if (fAttributes[c].fOverlay == nullptr)
+      own = c;
+    else if (HasAttribute(c, row)) {
+      value = fAttributes[c].fValues[row];
+      return true;
+    }
+  }
+  if (own >= 0 && HasAttribute(own, row)) {
+    value = fAttributes[own].fValues[row];
+    return true;
+  }
+  return false;
+}
+
+bool HAL::GenericData::LookupAttribute (ParticlePtr particle, const DataKey &key, long double &value) {
+  GenericData *owner = particle->GetAttributeData();
+
+  if (owner == nullptr)
+    return false;
+
+  size_t row = particle->GetAttributeRow();
+  int column;
+
+  // nearest overlay first, the particle's own value last
+  for (GenericData *data = this; data != nullptr; data = data->fSource) {
+    if (data == owner)
+      continue;
+    column = owner->FindAttribute(key, data);
+    if (column >= 0 && owner->HasAttribute(column, row)) {
+      value = owner->GetAttribute(column, row);
+      return true;
+    }
+  }
+  column = owner->FindAttribute(key);
+  if (column >= 0 && owner->HasAttribute(column, row)) {
+    value = owner->GetAttribute(column, row);
+    return true;
+  }
+  return false;
+}
+
+bool HAL::GenericData::HasAttribute (ParticlePtr particle, const DataKey &key) {
+  long double value;
+
+  return LookupAttribute(particle, key, value);
+}
+
+long double HAL::GenericData::GetAttribute (ParticlePtr particle, const DataKey &key) {
+  long double value = 0.0;
+
+  LookupAttribute(particle, key, value);
+  return value;
+}
+
+void HAL::GenericData::SetAttribute (ParticlePtr particle, const DataKey &key, const long double &value) {
+  GenericData *owner = particle->GetAttributeData();
+
+  if (owner == nullptr)
+    throw HALException(key.GetName().Prepend("Particle must be added to a GenericData that owns it before setting attribute: "));
+  owner->SetAttribute(owner->RegisterAttribute(key, owner == this ? nullptr : this), 
+                      particle->GetAttributeRow(), value);
+}
+
+void HAL::GenericData::GetAttributeNames (ParticlePtr particle, std::set<TString> &names) {
+  GenericData *owner = particle->GetAttributeData();
+
+  if (owner == nullptr)
+    return;
+
+  size_t row = particle->GetAttributeRow();
+
+  for (unsigned c = 0; c < owner->fAttributes.size(); ++c) {
+    const GenericData *overlay = owner->fAttributes[c].fOverlay;
+    bool visible = (overlay == nullptr);
+    for (GenericData *data = this; data != nullptr && !visible; data = data->fSource)
+      visible = (data == overlay);
+    if (visible && owner->HasAttribute(c, row))
+      names.insert(owner->fAttributes[c].fKey.GetName());
+  }
+}
+
+bool HAL::GenericData::GatherAttribute (const DataKey &key, std::vector<long double> &values) {
+  bool complete = true;
+
+  values.assign(fParticles.size(), 0.0);
+  for (size_t i = 0; i < fParticles.size(); ++i) {
+    if (!LookupAttribute(fParticles[i], key, values[i]))
+      complete = false;
+  }
+  return complete;
+}
+
+ParticleCollection& HAL::GenericData::GetCollection () {
+  if (IsSelection()) {
+    // the source is brought up to date first, it may have been invalidated
+    const ParticleCollection &source = fSource->GetCollection();
+
+    if (!fCollectionValid || fSourceGeneration != fSource->fCollectionGeneration) {
+      fCollection.Select(source, fSourceIndices, this);
+      fSourceGeneration = fSource->fCollectionGeneration;
+      fCollectionValid = true;
+      fSorted.clear();
+      ++fCollectionGeneration;
+    }
+  }
+  else if (!fCollectionValid) {
+    fCollection.Assign(fParticles.begin(), fParticles.end(), this);
+    fCollectionValid = true;
+    ++fCollectionGeneration;
+  }
+  return fCollection;
+}
+
+const std::vector<size_t>& HAL::GenericData::GetSortedIndices (GenericParticle::Kinematic property, bool descending) {
+  // the particles of a selection belong to its source, so only the source is
+  // told when they change; bringing the collection up to date drops stale orders
+  if (IsSelection())
+    GetCollection();
+  for (std::deque<SortedIndices>::iterator sorted = fSorted.begin(); sorted != fSorted.end(); ++sorted) {
+    if (sorted->fProperty == property && sorted->fDescending == descending)
+      return sorted->fIndices;
+  }
+
+  size_t n = fParticles.size();
+  std::vector<double> values(n);
+
+  fSorted.push_back(SortedIndices());
+  fSorted.back().fProperty = property;
+  fSorted.back().fDescending = descending;
+  std::vector<size_t> &indices = fSorted.back().fIndices;
+  indices.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = fParticles[i]->GetKinematic(property);
+    indices[i] = i;
   }
+  std::stable_sort(indices.begin(), indices.end(), IndexCompare(values, descending));
+  return indices;
 }
 
 std::ostream& operator<<(std::ostream& os, HAL::GenericData &data) {
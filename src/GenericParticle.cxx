@@ -2,7 +2,14 @@
 #ifdef BOOST_NO_CXX11_RANGE_BASED_FOR
 #include <aux/boost/foreach.hpp>
 #endif
+#include <algorithm>
+#include <set>
 #include <TLorentzVector.h>
+#include <TVector2.h>
+#include <TMath.h>
+#include <HAL/EventArena.h>
+#include <HAL/GenericData.h>
+#include <HAL/Exceptions.h>
 
 ClassImp(HAL::GenericParticle);
 
@@ -11,7 +18,8 @@ namespace HAL
 
 //______________________________________________________________________________
 HAL::GenericParticle::GenericParticle (const TString &owner, const TString &origin, const TString &name) : 
-  fOwner(owner), fOwnerIndex(0), fOriginIndex(0), fID(0), fCharge(0.0), fP(nullptr) 
+  fOwner(owner), fOwnerIndex(0), fOriginIndex(0), fHasOriginIndex(false), fID(0), fCharge(0.0), fP(nullptr), fCached(0), 
+  fAttributeData(nullptr), fAttributeRow(0) 
 {
 
   if(origin.EqualTo("")) 
@@ -30,23 +38,267 @@ HAL::GenericParticle::GenericParticle (const GenericParticle &particle) :
   fOrigin = particle.fOrigin;
   fOwnerIndex = particle.fOwnerIndex;
   fOriginIndex = particle.fOriginIndex;
+  fHasOriginIndex = particle.fHasOriginIndex;
   fID = particle.fID;
   fCharge = particle.fCharge;
   fP = new TLorentzVector(*particle.fP);
+  fCached = particle.fCached;
+  std::copy(particle.fKinematics, particle.fKinematics + kNKinematics, fKinematics);
+  // the attributes are copied once the copy is added to its owner
+  fAttributeData = particle.fAttributeData;
+  fAttributeRow = particle.fAttributeRow;
   fScalarAttributes = particle.fScalarAttributes;
-  f1DParticles = particle.f1DParticles;
+  fOriginKey = particle.fOriginKey;
+  fRelations = particle.fRelations;
 }
 
 //______________________________________________________________________________
 HAL::GenericParticle::~GenericParticle () 
 {
-  if (fP) delete fP;
+  if (fP && !EventArena::Contains(fP)) delete fP;
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::Reset (const TString &owner, const TString &origin, const TString &name) 
+{
+  if (fP && !EventArena::Contains(fP)) delete fP;
+  fOwner = owner;
+  fOrigin = origin.EqualTo("") ? owner : origin;
+  fOwnerIndex = 0;
+  fOriginIndex = 0;
+  fHasOriginIndex = false;
+  fID = 0;
+  fCharge = 0.0;
+  fP = nullptr;
+  fCached = 0;
+  fAttributeData = nullptr;
+  fAttributeRow = 0;
+  fScalarAttributes.clear();
+  fOriginKey = DataKey();
+  fRelations.clear();
+  SetName(name.Data());
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::Assign (const GenericParticle &particle, TLorentzVector *vec) 
+{
+  if (fP && !EventArena::Contains(fP)) delete fP;
+  fOwner = particle.fOwner;
+  fOrigin = particle.fOrigin;
+  fOwnerIndex = particle.fOwnerIndex;
+  fOriginIndex = particle.fOriginIndex;
+  fHasOriginIndex = particle.fHasOriginIndex;
+  fID = particle.fID;
+  fCharge = particle.fCharge;
+  fP = vec;
+  // only the components are copied, so a pooled vec keeps its arena tag
+  if (particle.fP)
+    fP->SetPxPyPzE(particle.fP->Px(), particle.fP->Py(), particle.fP->Pz(), particle.fP->E());
+  fCached = particle.fCached;
+  std::copy(particle.fKinematics, particle.fKinematics + kNKinematics, fKinematics);
+  fAttributeData = particle.fAttributeData;
+  fAttributeRow = particle.fAttributeRow;
+  fScalarAttributes = particle.fScalarAttributes;
+  fOriginKey = particle.fOriginKey;
+  fRelations = particle.fRelations;
+  SetName("");
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::InvalidateOwner () 
+{
+  fAttributeData->InvalidateCollection();
+}
+
+//______________________________________________________________________________
+double HAL::GenericParticle::CacheKinematic (Kinematic k) 
+{
+  double value = 0.0;
+
+  switch (k) {
+    case kPt:       value = fP->Pt(); break;
+    case kEta:      value = fP->Eta(); break;
+    case kPhi:      value = fP->Phi(); break;
+    case kM:        value = fP->M(); break;
+    case kE:        value = fP->E(); break;
+    case kEt:       value = fP->Et(); break;
+    case kP3:       value = fP->P(); break;
+    case kRapidity: value = fP->Rapidity(); break;
+    default:
+      throw HALException("Unknown kinematic quantity requested from particle");
+  }
+  fKinematics[k] = value;
+  fCached |= (1u << k);
+  return value;
+}
+
+//______________________________________________________________________________
+double HAL::GenericParticle::DeltaR (GenericParticle *particle) 
+{
+  double deta = GetEta() - particle->GetEta();
+  double dphi = TVector2::Phi_mpi_pi(GetPhi() - particle->GetPhi());
+
+  return TMath::Sqrt(deta*deta + dphi*dphi);
+}
+
+//______________________________________________________________________________
+double HAL::GenericParticle::DeltaPhi (GenericParticle *particle) 
+{
+  return TVector2::Phi_mpi_pi(GetPhi() - particle->GetPhi());
 }
 
 //______________________________________________________________________________
 void HAL::GenericParticle::SetAttribute (const TString &name, const long double &value) 
 {
-  fScalarAttributes[name] = value;
+  if (fAttributeData == nullptr)
+    fScalarAttributes[name] = value;
+  else
+    SetAttribute(DataKey(name), value);
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::SetAttribute (const DataKey &key, const long double &value) 
+{
+  if (fAttributeData == nullptr)
+    fScalarAttributes[key.GetName()] = value;
+  else
+    fAttributeData->SetAttribute(fAttributeData->RegisterAttribute(key), fAttributeRow, value);
+}
+
+//______________________________________________________________________________
+long double HAL::GenericParticle::GetAttribute (const TString &name) 
+{
+  if (fAttributeData == nullptr) {
+    std::map<TString, long double, internal::string_cmp>::iterator it = fScalarAttributes.find(name);
+    return it != fScalarAttributes.end() ? it->second : 0.0;
+  }
+  return GetAttribute(DataKey::Find(name));
+}
+
+//______________________________________________________________________________
+long double HAL::GenericParticle::GetAttribute (const DataKey &key) 
+{
+  long double value = 0.0;
+
+  if (fAttributeData != nullptr)
+    fAttributeData->FindParticleAttribute(fAttributeRow, key, value);
+  else if (key.IsValid())
+    return GetAttribute(key.GetName());
+  return value;
+}
+
+//______________________________________________________________________________
+bool HAL::GenericParticle::HasAttribute (const TString &name) 
+{
+  if (fAttributeData == nullptr)
+    return fScalarAttributes.count(name) != 0;
+  return HasAttribute(DataKey::Find(name));
+}
+
+//______________________________________________________________________________
+bool HAL::GenericParticle::HasAttribute (const DataKey &key) 
+{
+  long double value;
+
+  if (fAttributeData == nullptr)
+    return key.IsValid() && fScalarAttributes.count(key.GetName()) != 0;
+  return fAttributeData->FindParticleAttribute(fAttributeRow, key, value);
+}
+
+//______________________________________________________________________________
+std::map<TString, long double, internal::string_cmp>& HAL::GenericParticle::GetAttributes () 
+{
+  if (fAttributeData != nullptr) {
+    std::set<TString> names;
+    fAttributeData->GetAttributeNames(this, names);
+    fScalarAttributes.clear();
+    for (std::set<TString>::iterator name = names.begin(); name != names.end(); ++name)
+      fScalarAttributes[*name] = GetAttribute(*name);
+  }
+  return fScalarAttributes;
+}
+
+//______________________________________________________________________________
+unsigned long long HAL::GenericParticle::GetIdentity () 
+{
+  // addresses are tagged with the top bit, which symbol ids never reach
+  if (!fHasOriginIndex)
+    return (unsigned long long)(size_t)this | (1ULL << 63);
+  return ((unsigned long long)GetOriginKey().GetID() << 32) | (fOriginIndex & 0xFFFFFFFFULL);
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::Relation::Add (GenericParticle *particle) 
+{
+  bool has_origin = particle->HasOriginIndex();
+  unsigned origin = has_origin ? particle->GetOriginKey().GetID() : internal::SymbolTable::kNoSymbol;
+  unsigned long long key = particle->GetIdentity();
+  // the mask bit of a particle without an origin index comes from its address
+  size_t index = has_origin ? particle->GetOriginIndex() : (size_t)(key >> 4);
+  std::vector<unsigned long long>::iterator pos = std::upper_bound(fKeys.begin(), fKeys.end(), key);
+
+  // a repeated member can't be told apart by the mask
+  if (pos != fKeys.begin() && *(pos - 1) == key)
+    fExact = false;
+  fKeys.insert(pos, key);
+  fParticles.push_back(particle);
+  fMask |= 1ULL << (index % 64);
+  if (fParticles.size() == 1)
+    fOrigin = origin;
+  else if (origin != fOrigin)
+    fOrigin = internal::SymbolTable::kNoSymbol;
+  if (fOrigin == internal::SymbolTable::kNoSymbol || index >= 64)
+    fExact = false;
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::Relation::Rebuild () 
+{
+  ParticlePtrs particles;
+
+  particles.swap(fParticles);
+  fKeys.clear();
+  fMask = 0;
+  fOrigin = internal::SymbolTable::kNoSymbol;
+  fExact = true;
+  fDirty = false;
+  fKeys.reserve(particles.size());
+  fParticles.reserve(particles.size());
+  for (ParticlePtrsIt particle = particles.begin(); particle != particles.end(); ++particle)
+    Add(*particle);
+}
+
+//______________________________________________________________________________
+HAL::GenericParticle::Relation* HAL::GenericParticle::FindRelation (const DataKey &name) 
+{
+  for (std::vector<Relation>::iterator relation = fRelations.begin();
+       relation != fRelations.end(); ++relation) {
+    if (relation->fName == name)
+      return &(*relation);
+  }
+  return nullptr;
+}
+
+//______________________________________________________________________________
+HAL::GenericParticle::Relation* HAL::GenericParticle::FindSyncedRelation (const DataKey &name) 
+{
+  Relation *relation = FindRelation(name);
+
+  if (relation != nullptr && relation->fDirty)
+    relation->Rebuild();
+  return relation;
+}
+
+//______________________________________________________________________________
+HAL::GenericParticle::Relation& HAL::GenericParticle::AccessRelation (const DataKey &name) 
+{
+  Relation *relation = FindRelation(name);
+
+  if (relation != nullptr)
+    return *relation;
+  fRelations.push_back(Relation());
+  fRelations.back().fName = name;
+  return fRelations.back();
 }
 
 //______________________________________________________________________________
@@ -54,29 +306,106 @@ void HAL::GenericParticle::SetParticle (const TString &name,
                                         GenericParticle *particle, 
                                         const long long &index) 
 {
+  SetParticle(DataKey(name), particle, index);
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::SetParticle (const DataKey &name, 
+                                        GenericParticle *particle, 
+                                        const long long &index) 
+{
+  Relation &relation = AccessRelation(name);
+
+  if (relation.fDirty)
+    relation.Rebuild();
   if (index == -1)
-    f1DParticles[name].push_back(particle);
-  else
-    f1DParticles[name][index] = particle;
-  std::stable_sort(f1DParticles[name].begin(), f1DParticles[name].end());
+    relation.Add(particle);
+  else {
+    relation.fParticles[index] = particle;
+    relation.Rebuild();
+  }
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::SetParticles (const TString &name, const std::vector<GenericParticle*> &particles) 
+{
+  SetParticles(DataKey(name), particles);
+}
+
+//______________________________________________________________________________
+void HAL::GenericParticle::SetParticles (const DataKey &name, const std::vector<GenericParticle*> &particles) 
+{
+  Relation &relation = AccessRelation(name);
+
+  relation.fParticles = particles;
+  relation.Rebuild();
+}
+
+//______________________________________________________________________________
+ParticlePtrs& HAL::GenericParticle::GetParticles (const TString &name) 
+{
+  Relation &relation = AccessRelation(DataKey(name));
+
+  // the keys and mask are rebuilt the next time they are needed
+  relation.fDirty = true;
+  return relation.fParticles;
+}
+
+//______________________________________________________________________________
+const ParticlePtrs& HAL::GenericParticle::GetParticles (const DataKey &name) 
+{
+  static const ParticlePtrs empty;
+  Relation *relation = FindRelation(name);
+
+  return relation != nullptr ? relation->fParticles : empty;
+}
+
+//______________________________________________________________________________
+unsigned long long HAL::GenericParticle::GetParticleMask (const DataKey &name) 
+{
+  Relation *relation = FindSyncedRelation(name);
+
+  return relation != nullptr ? relation->fMask : 0;
 }
 
 //______________________________________________________________________________
-void HAL::GenericParticle::SetParticles (const TString &name, std::vector<GenericParticle*> &particles) 
+bool HAL::GenericParticle::HasSameParticles (const DataKey &name, ParticlePtr particle) 
 {
-  f1DParticles[name] = particles;
-  std::stable_sort(f1DParticles[name].begin(), f1DParticles[name].end());
+  Relation *mine = FindSyncedRelation(name);
+  Relation *other = particle->FindSyncedRelation(name);
+  size_t n = mine != nullptr ? mine->fParticles.size() : 0;
+  size_t m = other != nullptr ? other->fParticles.size() : 0;
+
+  if (n != m)
+    return false;
+  if (n == 0)
+    return true;
+  if (mine->fMask != other->fMask)
+    return false;
+  if (mine->fExact && other->fExact && mine->fOrigin == other->fOrigin)
+    return true;
+  return mine->fKeys == other->fKeys;
 }
 
 //______________________________________________________________________________
-bool HAL::GenericParticle::HasSameParticles (const TString &name, ParticlePtr particle) 
+bool HAL::GenericParticle::SharesParticles (const DataKey &name, ParticlePtr particle) 
 {
-  size_t n = GetNParticles(name);
-  size_t m = particle->GetNParticles(name);
+  Relation *mine = FindSyncedRelation(name);
+  Relation *other = particle->FindSyncedRelation(name);
+
+  if (mine == nullptr || other == nullptr || (mine->fMask & other->fMask) == 0)
+    return false;
+  if (mine->fExact && other->fExact && mine->fOrigin == other->fOrigin)
+    return true;
 
-  if (n == m) {
-    if (n != 0)
-      return (f1DParticles[name] == particle->GetParticles(name));
+  // both key lists are sorted
+  std::vector<unsigned long long>::const_iterator a = mine->fKeys.begin();
+  std::vector<unsigned long long>::const_iterator b = other->fKeys.begin();
+  while (a != mine->fKeys.end() && b != other->fKeys.end()) {
+    if (*a < *b)
+      ++a;
+    else if (*b < *a)
+      ++b;
     else
       return true;
   }
@@ -96,23 +425,31 @@ std::ostream& operator<<(std::ostream& os, const HAL::GenericParticle &particle)
        << "\t" << particle.fP->Pt() << "\t" << particle.fP->Eta() << "\t" << particle.fP->Phi()
        << "\t" << particle.fP->M() << "\t" << particle.fP->E() << "\n";
   }
-  if (!particle.fScalarAttributes.empty()) {
+  if (particle.fAttributeData == nullptr && !particle.fScalarAttributes.empty()) {
     os << "Scalar attributes:" << std::endl;
-    for (std::map<TString, long double>::const_iterator sa = particle.fScalarAttributes.begin();
-         sa != particle.fScalarAttributes.end(); ++sa) {
+    for (std::map<TString, long double, internal::string_cmp>::const_iterator sa = particle.fScalarAttributes.begin();
+         sa != particle.fScalarAttributes.end(); ++sa)
       os << "\tName: " << sa->first << "\t\tValue: " << sa->second << "\n";
+  }
+  if (particle.fAttributeData != nullptr && particle.fAttributeData->GetNAttributes() > 0) {
+    const GenericData *data = particle.fAttributeData;
+    os << "Scalar attributes:" << std::endl;
+    for (unsigned c = 0; c < data->GetNAttributes(); ++c) {
+      if (data->GetAttributeOverlay(c) == nullptr && data->HasAttribute(c, particle.fAttributeRow))
+        os << "\tName: " << data->GetAttributeKey(c).GetName() << "\t\tValue: " 
+           << data->GetAttribute(c, particle.fAttributeRow) << "\n";
     }
   }
-  if (!particle.f1DParticles.empty()) {
+  if (!particle.fRelations.empty()) {
     os << "Particle arrays:" << std::endl;
-    for (std::map<TString, ParticlePtrs>::const_iterator p = particle.f1DParticles.begin();
-         p != particle.f1DParticles.end(); ++p) {
+    for (std::vector<GenericParticle::Relation>::const_iterator p = particle.fRelations.begin();
+         p != particle.fRelations.end(); ++p) {
       size_t count = 0, 
-             n = p->second.size();
-      os << "\tName: " << p->first << "\t\tNumber of particles: " << n;
+             n = p->fParticles.size();
+      os << "\tName: " << p->fName.GetName() << "\t\tNumber of particles: " << n;
       if (n > 0)
         os << "\n\tList of particles: ";
-      for (ParticlePtrsConstIt part = p->second.begin(); part != p->second.end(); ++part) {
+      for (ParticlePtrsConstIt part = p->fParticles.begin(); part != p->fParticles.end(); ++part) {
         os << (*part)->GetOrigin() << "  " << (*part)->GetOriginIndex();
         if (++count < n)
           os << ",    ";
@@ -1,4 +1,5 @@
 #include <HAL/Algorithms/ImportParticle.h>
+#include <cmath>
 #include <iostream>
 
 namespace HAL
@@ -60,28 +61,114 @@ void internal::ImportParticleAlgo::Init (Option_t* /*option*/) {
 void internal::ImportParticleAlgo::Exec (unsigned n) {
   HAL::AnalysisData *data = GetUserData();
   HAL::AnalysisTreeReader *tr = GetRawData();
-  HAL::GenericData *gen_data = new GenericData(GetName(), true);
-
-  data->SetValue(GetName(), gen_data);
+  HAL::EventArena *arena = GetEventArena();
+  HAL::GenericData *gen_data = arena->New<GenericData>(GetName(), true);
+  const long double *charge = nullptr;
+  const long long *id = nullptr;
+  size_t n_particles = FillFourVectors(n), n_column = 0;
+
+  data->SetValue(GetNameKey(), gen_data);
+
+  // each branch is fetched once per event instead of once per particle
+  if (fHasCharge) {
+    charge = tr->GetDecimalArray(fCharge, n_column);
+    if (n_column < n_particles) n_particles = n_column;
+  }
+  if (fHasID) {
+    id = tr->GetIntegerArray(fID, n_column);
+    if (n_column < n_particles) n_particles = n_column;
+  }
 
-  for (unsigned i = 0; i < n; ++i) {
-    HAL::ParticlePtr particle = new HAL::Particle(GetName());
-    TLorentzVector *vec = MakeTLV(i);
+  for (size_t i = 0; i < n_particles; ++i) {
+    HAL::ParticlePtr particle = arena->NewParticle(GetName());
 
-    particle->SetP (vec);
-    if (fHasCharge) particle->SetCharge(tr->GetDecimal(fCharge, i));
-    if (fHasID) particle->SetID(tr->GetInteger(fID, i));
+    particle->SetP(arena->NewVector(fPxColumn[i], fPyColumn[i], fPzColumn[i], fEColumn[i]));
+    if (fHasCharge) particle->SetCharge(charge[i]);
+    if (fHasID) particle->SetID(id[i]);
+    particle->SetOriginIndex(i);
+    particle->SetOwnerIndex(i);
     gen_data->AddParticle(particle);
-    particle->SetOriginIndex(gen_data->GetNParticles() - 1);
-    particle->SetOwnerIndex(gen_data->GetNParticles() - 1);
   }
+  // the cartesian columns are already at hand, so downstream selections need
+  // not read them back from the particles
+  gen_data->GetCollection().SetCartesian(fPxColumn.data(), fPyColumn.data(), 
+                                         fPzColumn.data(), fEColumn.data());
 
   gen_data->SetRefType("none");
   IncreaseCounter(gen_data->GetNParticles());
 }
 
-void internal::ImportParticleAlgo::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
+size_t internal::ImportParticleAlgo::FillFourVectors (size_t n) {
+  HAL::AnalysisTreeReader *tr = GetRawData();
+  size_t n0 = n, n1 = n, n2 = n, n3 = n;
+
+  if (fIsCart) {
+    const long double *x0 = tr->GetDecimalArray(fCartX0, n0),
+                      *x1 = tr->GetDecimalArray(fCartX1, n1),
+                      *x2 = tr->GetDecimalArray(fCartX2, n2),
+                      *x3 = tr->GetDecimalArray(fCartX3, n3);
+    n = std::min(std::min(n, n0), std::min(std::min(n1, n2), n3));
+    fPxColumn.assign(x1, x1 + n);
+    fPyColumn.assign(x2, x2 + n);
+    fPzColumn.assign(x3, x3 + n);
+    fEColumn.assign(x0, x0 + n);
+  }
+  else if (fIsE || fIsM) {
+    const long double *pt = tr->GetDecimalArray(fPt, n0),
+                      *eta = tr->GetDecimalArray(fEta, n1),
+                      *phi = tr->GetDecimalArray(fPhi, n2),
+                      *x3 = tr->GetDecimalArray(fIsE ? fE : fM, n3);
+    n = std::min(std::min(n, n0), std::min(std::min(n1, n2), n3));
+    fPxColumn.resize(n);
+    fPyColumn.resize(n);
+    fPzColumn.resize(n);
+    fEColumn.resize(n);
+    // same arithmetic as TLorentzVector::SetPtEtaPhiE and SetPtEtaPhiM
+    for (size_t i = 0; i < n; ++i) {
+      double p_t = TMath::Abs((double)pt[i]), phi_i = (double)phi[i];
+      fPxColumn[i] = p_t*TMath::Cos(phi_i);
+      fPyColumn[i] = p_t*TMath::Sin(phi_i);
+      fPzColumn[i] = p_t*sinh((double)eta[i]);
+    }
+    if (fIsE) {
+      for (size_t i = 0; i < n; ++i)
+        fEColumn[i] = (double)x3[i];
+    }
+    else {
+      for (size_t i = 0; i < n; ++i) {
+        double x = fPxColumn[i], y = fPyColumn[i], z = fPzColumn[i], m = (double)x3[i];
+        fEColumn[i] = (m >= 0) ? TMath::Sqrt(x*x + y*y + z*z + m*m) : 
+                                 TMath::Sqrt(TMath::Max((x*x + y*y + z*z - m*m), 0.));
+      }
+    }
+  }
+  else if (fIsCartMET) {
+    const long double *x1 = tr->GetDecimalArray(fCartX1, n1),
+                      *x2 = tr->GetDecimalArray(fCartX2, n2);
+    n = std::min(n, std::min(n1, n2));
+    fPxColumn.assign(x1, x1 + n);
+    fPyColumn.assign(x2, x2 + n);
+    fPzColumn.assign(n, 0.0);
+    fEColumn.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      fEColumn[i] = TMath::Sqrt(x1[i]*x1[i] + x2[i]*x2[i]);
+  }
+  else if (fIsPhiEtMET) {
+    const long double *phi = tr->GetDecimalArray(fPhi, n1),
+                      *pt = tr->GetDecimalArray(fPt, n2);
+    n = std::min(n, std::min(n1, n2));
+    fPxColumn.resize(n);
+    fPyColumn.resize(n);
+    fPzColumn.assign(n, 0.0);
+    fEColumn.assign(pt, pt + n);
+    for (size_t i = 0; i < n; ++i) {
+      fPxColumn[i] = pt[i]*TMath::Cos(phi[i]);
+      fPyColumn[i] = pt[i]*TMath::Sin(phi[i]);
+    }
+  }
+  else
+    throw HAL::HALException("Couldn't identify type in ImportParticle");
+  return n;
 }
 
 
@@ -146,41 +233,4 @@ void Algorithms::ImportParticle::Exec (Option_t* /*option*/) {
   ImportParticleAlgo::Exec(n);
 }
 
-TLorentzVector* Algorithms::ImportParticle::MakeTLV (unsigned i) {
-  HAL::AnalysisTreeReader *tr = GetRawData();
-
-  if (fIsCart) {
-    long double x0 = tr->GetDecimal(fCartX0, i),
-                x1 = tr->GetDecimal(fCartX1, i),
-                x2 = tr->GetDecimal(fCartX2, i),
-                x3 = tr->GetDecimal(fCartX3, i);
-    return new TLorentzVector(x1, x2, x3, x0);
-  }
-  else if (fIsE) {
-    long double e = tr->GetDecimal(fE, i),
-                pT = tr->GetDecimal(fPt, i),
-                eta = tr->GetDecimal(fEta, i),
-                phi = tr->GetDecimal(fPhi, i);
-    return HAL::makeTLVFromPtEtaPhiE(pT, eta, phi, e);
-  }
-  else if (fIsM) {
-    long double m = tr->GetDecimal(fM, i),
-                pT = tr->GetDecimal(fPt, i),
-                eta = tr->GetDecimal(fEta, i),
-                phi = tr->GetDecimal(fPhi, i);
-    return HAL::makeTLVFromPtEtaPhiM(pT, eta, phi, m);
-  }
-  else if (fIsCartMET) {
-    long double x1 = tr->GetDecimal(fCartX1, i),
-                x2 = tr->GetDecimal(fCartX2, i);
-    return new TLorentzVector(x1, x2, 0.0, TMath::Sqrt(x1*x1 + x2*x2));
-  }
-  else if (fIsPhiEtMET) {
-    long double phi = tr->GetDecimal(fPhi, i),
-                pt = tr->GetDecimal(fPt, i);
-    return new TLorentzVector(pt*TMath::Cos(phi), pt*TMath::Sin(phi), 0.0, pt);
-  }
-  throw HAL::HALException("Couldn't identify type in ImportParticle");
-}
-
 } /* HAL */ 
@@ -1,35 +1,259 @@
 #include <HAL/Algorithms/Monitor.h>
+#include <HAL/ParticleCollection.h>
+#include <HAL/RingBuffer.h>
+#include <TH1D.h>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
 
 namespace HAL
 {
 
 /*
- * Monitoring Algorithms
+ * Background consumer of the snapshots of one monitor
  * */
+class internal::MonitorWorker {
+public:
+  MonitorWorker (SamplingMonitorAlgo *monitor, size_t capacity) :
+    fMonitor(monitor), fBuffer(capacity), fStop(false), fNConsumed(0) {}
+
+  void  Start () {fThread = std::thread(&MonitorWorker::Run, this);}
+  //! Consume everything still queued and wait for the thread to finish
+  void  Stop ()
+  {
+    fStop.store(true, std::memory_order_release);
+    if (fThread.joinable())
+      fThread.join();
+  }
+  bool  Push (const MonitorSnapshot &snapshot) {return fBuffer.Push(snapshot);}
+  size_t GetNDropped () const {return fBuffer.GetNDropped();}
+  size_t GetNConsumed () const {return fNConsumed;}
+
+private:
+  void  Run ()
+  {
+    while (!fStop.load(std::memory_order_acquire)) {
+      if (!Drain())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Drain();
+  }
+
+  bool  Drain ()
+  {
+    MonitorSnapshot snapshot;
+    bool any = false;
+
+    while (fBuffer.Pop(snapshot)) {
+      any = true;
+      ++fNConsumed;
+      if (fMonitor->fHistograms)
+        fMonitor->Fill(snapshot, fMonitor->fHists);
+      else {
+        // one write per snapshot keeps the lines of different monitors apart
+        std::ostringstream line;
+        fMonitor->Format(snapshot, line);
+        (*fMonitor->fOS) << line.str();
+        fMonitor->fOS->flush();
+      }
+    }
+    return any;
+  }
+
+  SamplingMonitorAlgo                *fMonitor;
+  RingBuffer<MonitorSnapshot>         fBuffer;
+  std::atomic<bool>                   fStop;
+  size_t                              fNConsumed;
+  std::thread                         fThread;
+};
+
+internal::SamplingMonitorAlgo::SamplingMonitorAlgo (TString name, TString title,
+                                                    long long period, std::ostream &os) :
+  Algorithm(name, title), fN(period < 1 ? 1 : period), fNEvents(0), fOS(&os),
+  fHistograms(false), fBufferSize(1024), fWorker(nullptr) {
+}
 
-void Algorithms::MonitorAlgorithm::Exec (Option_t* /*option*/) {
-  HAL::AnalysisData *data = GetUserData();
+internal::SamplingMonitorAlgo::~SamplingMonitorAlgo () {
+  if (fWorker != nullptr)
+    fWorker->Stop();
+  delete fWorker;
+  for (std::vector<TH1D*>::iterator it = fHists.begin(); it != fHists.end(); ++it)
+    delete *it;
+}
+
+void internal::SamplingMonitorAlgo::SlaveBegin (Option_t* /*option*/) {
+  fNEvents = 0;
+  if (fHistograms && fHists.empty()) {
+    // histograms are booked here because ROOT object creation is not thread safe
+    bool add_directory = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    Book(fHists);
+    TH1::AddDirectory(add_directory);
+  }
+  if (fWorker == nullptr) {
+    fWorker = new MonitorWorker(this, fBufferSize);
+    fWorker->Start();
+  }
+}
+
+void internal::SamplingMonitorAlgo::Exec (Option_t* /*option*/) {
+  if (++fNEvents % fN != 0)
+    return;
+
+  // without SlaveBegin (e.g. when run by hand) the snapshots are formatted right away
+  MonitorSnapshot snapshot;
   HAL::AnalysisTreeReader *tr = GetRawData();
-  HAL::GenericData *input_data = NULL;
 
-  if ((tr->GetEntryNumber() + 1) % fN == 0) {
-    (*fOS) << "\nSummary for algorithm - " << fInput.Data() << std::endl;
+  snapshot.fEntry = (tr != nullptr) ? tr->GetEntryNumber() : fNEvents - 1;
+  Sample(GetUserData(), snapshot);
+  if (fWorker != nullptr)
+    fWorker->Push(snapshot);
+  else
+    Format(snapshot, *fOS);
+}
+
+void internal::SamplingMonitorAlgo::SlaveTerminate (Option_t* /*option*/) {
+  if (fWorker == nullptr)
+    return;
+  fWorker->Stop();
 
-    if (data->Exists(fInput))
-      input_data = (GenericData*)data->GetTObject(fInput);
-    else {
-      (*fOS) << "Algorithm is empty!" << std::endl;
-      return;
+  std::ostream &os = *fOS;
+  if (fHistograms) {
+    os << "\nSummary for monitor - " << GetName() << std::endl;
+    for (std::vector<TH1D*>::iterator it = fHists.begin(); it != fHists.end(); ++it) {
+      os << "  " << (*it)->GetTitle() << ": entries " << (*it)->GetEntries()
+         << ", mean " << (*it)->GetMean() << ", rms " << (*it)->GetRMS() << std::endl;
+    }
+    // the output file takes the histograms over; the next SlaveBegin books new ones
+    HAL::AnalysisTreeWriter *output = GetUserOutput();
+    if (output != nullptr) {
+      for (std::vector<TH1D*>::iterator it = fHists.begin(); it != fHists.end(); ++it) {
+        (*it)->BufferEmpty();
+        output->AddObject(*it);
+      }
+      fHists.clear();
     }
+  }
+  if (fWorker->GetNDropped() > 0)
+    os << "Monitor " << GetName() << " dropped " << fWorker->GetNDropped() << " of "
+       << fWorker->GetNDropped() + fWorker->GetNConsumed() << " snapshots" << std::endl;
+  delete fWorker;
+  fWorker = nullptr;
+}
 
-    (*fOS) << *input_data << std::endl;
+/*
+ * Monitoring Algorithms
+ * */
+
+void Algorithms::MonitorAlgorithm::Sample (HAL::AnalysisData *data,
+                                           HAL::internal::MonitorSnapshot &snapshot) {
+  if (!data->Exists(fInputKey))
+    return;
+
+  HAL::GenericData *input_data = (GenericData*)data->GetTObject(fInputKey);
+  TString ref_type = input_data->GetRefType();
+
+  snapshot.fExists = true;
+  // particle algorithms use "none" (or nothing) as their reference type
+  if (ref_type.EqualTo("bool") || ref_type.EqualTo("integer") ||
+      ref_type.EqualTo("counting") || ref_type.EqualTo("decimal")) {
+    snapshot.fIsValue = true;
+    if (ref_type.EqualTo("bool"))
+      snapshot.fValue = data->GetBool(input_data->GetRefName());
+    else if (ref_type.EqualTo("integer"))
+      snapshot.fValue = data->GetInteger(input_data->GetRefName());
+    else if (ref_type.EqualTo("counting"))
+      snapshot.fValue = data->GetCounting(input_data->GetRefName());
+    else
+      snapshot.fValue = data->GetDecimal(input_data->GetRefName());
+    return;
+  }
+
+  const ParticleCollection &particles = input_data->GetCollection();
+  const double *pt = particles.GetPt(), *eta = particles.GetEta(), *phi = particles.GetPhi();
+
+  snapshot.fN = particles.GetSize();
+  for (size_t i = 0; i < snapshot.fN; ++i) {
+    snapshot.fSumPt += pt[i];
+    if (i == 0 || pt[i] > snapshot.fLeadPt) {
+      snapshot.fLeadPt = pt[i];
+      snapshot.fLeadEta = eta[i];
+      snapshot.fLeadPhi = phi[i];
+    }
+  }
+}
+
+void Algorithms::MonitorAlgorithm::Format (const HAL::internal::MonitorSnapshot &snapshot,
+                                           std::ostream &os) {
+  os << "\nSummary for algorithm - " << fInput.Data() << " (entry " << snapshot.fEntry << ")" << std::endl;
+  if (!snapshot.fExists)
+    os << "Algorithm is empty!" << std::endl;
+  else if (snapshot.fIsValue)
+    os << "Value: " << snapshot.fValue << std::endl;
+  else {
+    os << "Particles: " << snapshot.fN << "    scalar sum pT: " << snapshot.fSumPt << std::endl;
+    if (snapshot.fN > 0)
+      os << "Leading particle pT: " << snapshot.fLeadPt << "    eta: " << snapshot.fLeadEta
+         << "    phi: " << snapshot.fLeadPhi << std::endl;
   }
 }
 
-void Algorithms::MonitorUserData::Exec (Option_t* /*option*/) {
-  //HAL::AnalysisData *data = GetUserData();
+void Algorithms::MonitorAlgorithm::Book (std::vector<TH1D*> &histograms) {
+  TString name(GetName());
+
+  histograms.push_back(new TH1D(name + "_n", fInput + " multiplicity", 50, 0.0, 50.0));
+  histograms.push_back(new TH1D(name + "_value", fInput + " value", 100, 0.0, 0.0));
+  histograms.push_back(new TH1D(name + "_lead_pt", fInput + " leading pT", 100, 0.0, 0.0));
+  histograms.push_back(new TH1D(name + "_lead_eta", fInput + " leading eta", 100, -5.0, 5.0));
+  histograms.push_back(new TH1D(name + "_sum_pt", fInput + " scalar sum pT", 100, 0.0, 0.0));
+  // automatic ranges are chosen once enough entries have been buffered
+  for (std::vector<TH1D*>::iterator it = histograms.begin(); it != histograms.end(); ++it)
+    (*it)->SetBuffer(1000);
+}
+
+void Algorithms::MonitorAlgorithm::Fill (const HAL::internal::MonitorSnapshot &snapshot,
+                                         std::vector<TH1D*> &histograms) {
+  if (!snapshot.fExists)
+    return;
+  if (snapshot.fIsValue) {
+    histograms[1]->Fill(snapshot.fValue);
+    return;
+  }
+  histograms[0]->Fill(snapshot.fN);
+  histograms[4]->Fill(snapshot.fSumPt);
+  if (snapshot.fN > 0) {
+    histograms[2]->Fill(snapshot.fLeadPt);
+    histograms[3]->Fill(snapshot.fLeadEta);
+  }
+}
+
+void Algorithms::MonitorUserData::Sample (HAL::AnalysisData *data,
+                                          HAL::internal::MonitorSnapshot &snapshot) {
+  snapshot.fExists = true;
+  snapshot.fN = data->GetNNames();
+  snapshot.fNValues = data->GetNValues();
+}
+
+void Algorithms::MonitorUserData::Format (const HAL::internal::MonitorSnapshot &snapshot,
+                                          std::ostream &os) {
+  os << "UserData has " << snapshot.fN << " names, " << snapshot.fNValues
+     << " with values (entry " << snapshot.fEntry << ")" << std::endl;
+}
+
+void Algorithms::MonitorUserData::Book (std::vector<TH1D*> &histograms) {
+  TString name(GetName());
+
+  histograms.push_back(new TH1D(name + "_names", "UserData names", 100, 0.0, 0.0));
+  histograms.push_back(new TH1D(name + "_values", "UserData names with values", 100, 0.0, 0.0));
+  for (std::vector<TH1D*>::iterator it = histograms.begin(); it != histograms.end(); ++it)
+    (*it)->SetBuffer(1000);
+}
 
-  (*fOS) << "UserData has the following elements:" << std::endl;
+void Algorithms::MonitorUserData::Fill (const HAL::internal::MonitorSnapshot &snapshot,
+                                        std::vector<TH1D*> &histograms) {
+  histograms[0]->Fill(snapshot.fN);
+  histograms[1]->Fill(snapshot.fNValues);
 }
 
-} /* HAL */ 
+} /* HAL */
@@ -0,0 +1,173 @@
+#include <HAL/ParticleCollection.h>
+#include <TLorentzVector.h>
+#include <HAL/GenericData.h>
+
+namespace HAL
+{
+
+//______________________________________________________________________________
+void ParticleCollection::Assign (ParticlePtrsConstIt first, ParticlePtrsConstIt last, 
+                                 GenericData *data)
+{
+  Clear();
+  fData = data;
+  fParticles.assign(first, last);
+
+  size_t n = fParticles.size();
+  fCharge.resize(n);
+  fID.resize(n);
+  fOriginIndex.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    ParticlePtr particle = fParticles[i];
+    fCharge[i] = particle->GetCharge();
+    fID[i] = particle->GetID();
+    fOriginIndex[i] = particle->GetOriginIndex();
+  }
+}
+
+//______________________________________________________________________________
+void ParticleCollection::Select (const ParticleCollection &parent, 
+                                 const std::vector<size_t> &indices, GenericData *data)
+{
+  Clear();
+  fData = data;
+  fParent = &parent;
+  fParentIndex.assign(indices.begin(), indices.end());
+
+  size_t n = fParentIndex.size();
+  fParticles.resize(n);
+  fCharge.resize(n);
+  fID.resize(n);
+  fOriginIndex.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    size_t j = fParentIndex[i];
+    fParticles[i] = parent.fParticles[j];
+    fCharge[i] = parent.fCharge[j];
+    fID[i] = parent.fID[j];
+    fOriginIndex[i] = parent.fOriginIndex[j];
+  }
+}
+
+//______________________________________________________________________________
+void ParticleCollection::SetCartesian (const double *px, const double *py, 
+                                       const double *pz, const double *e)
+{
+  size_t n = fParticles.size();
+
+  fPx.assign(px, px + n);
+  fPy.assign(py, py + n);
+  fPz.assign(pz, pz + n);
+  fE.assign(e, e + n);
+  fHasCartesian = true;
+}
+
+//______________________________________________________________________________
+void ParticleCollection::Clear ()
+{
+  fData = nullptr;
+  fParent = nullptr;
+  fParentIndex.clear();
+  fParticles.clear();
+  fCharge.clear();
+  fID.clear();
+  fOriginIndex.clear();
+  fHasPolar = false;
+  fHasCartesian = false;
+}
+
+//______________________________________________________________________________
+void ParticleCollection::Reserve (size_t n)
+{
+  fParticles.reserve(n);
+  fCharge.reserve(n);
+  fID.reserve(n);
+  fOriginIndex.reserve(n);
+}
+
+//______________________________________________________________________________
+bool ParticleCollection::GatherAttribute (const DataKey &key, std::vector<long double> &values) const
+{
+  if (fData != nullptr)
+    return fData->GatherAttribute(key, values);
+
+  bool complete = true;
+
+  values.assign(fParticles.size(), 0.0);
+  for (size_t i = 0; i < fParticles.size(); ++i) {
+    GenericData *owner = fParticles[i]->GetAttributeData();
+    if (owner == nullptr || 
+        !owner->FindParticleAttribute(fParticles[i]->GetAttributeRow(), key, values[i]))
+      complete = false;
+  }
+  return complete;
+}
+
+//______________________________________________________________________________
+void ParticleCollection::FillPolar () const
+{
+  if (fHasPolar)
+    return;
+
+  size_t n = fParticles.size();
+  fPt.resize(n);
+  fEta.resize(n);
+  fPhi.resize(n);
+  fM.resize(n);
+  if (fParent != nullptr) {
+    const double *pt = fParent->GetPt(), *eta = fParent->GetEta(), 
+                 *phi = fParent->GetPhi(), *m = fParent->GetM();
+    for (size_t i = 0; i < n; ++i) {
+      size_t j = fParentIndex[i];
+      fPt[i] = pt[j];
+      fEta[i] = eta[j];
+      fPhi[i] = phi[j];
+      fM[i] = m[j];
+    }
+    fHasPolar = true;
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    ParticlePtr particle = fParticles[i];
+    fPt[i] = particle->GetPt();
+    fEta[i] = particle->GetEta();
+    fPhi[i] = particle->GetPhi();
+    fM[i] = particle->GetM();
+  }
+  fHasPolar = true;
+}
+
+//______________________________________________________________________________
+void ParticleCollection::FillCartesian () const
+{
+  if (fHasCartesian)
+    return;
+
+  size_t n = fParticles.size();
+  fPx.resize(n);
+  fPy.resize(n);
+  fPz.resize(n);
+  fE.resize(n);
+  if (fParent != nullptr) {
+    const double *px = fParent->GetPx(), *py = fParent->GetPy(), 
+                 *pz = fParent->GetPz(), *e = fParent->GetE();
+    for (size_t i = 0; i < n; ++i) {
+      size_t j = fParentIndex[i];
+      fPx[i] = px[j];
+      fPy[i] = py[j];
+      fPz[i] = pz[j];
+      fE[i] = e[j];
+    }
+    fHasCartesian = true;
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const TLorentzVector *vec = fParticles[i]->GetP();
+    fPx[i] = vec->Px();
+    fPy[i] = vec->Py();
+    fPz[i] = vec->Pz();
+    fE[i] = vec->E();
+  }
+  fHasCartesian = true;
+}
+
+} /* HAL */
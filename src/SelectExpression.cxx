@@ -0,0 +1,29 @@
+#include <HAL/Algorithms/SelectExpression.h>
+
+namespace HAL
+{
+
+Algorithms::SelectExpression::SelectExpression (TString name, TString title, TString input, 
+    TString expression) : 
+  FilterParticleAlgo(name, title, input) {
+
+  fExpression.Compile(expression);
+}
+
+bool Algorithms::SelectExpression::FilterPredicate (ParticlePtr particle) {
+  // attributes are read from the particle's own container
+  fSingle.assign(1, particle);
+  fSingleCollection.Assign(fSingle.begin(), fSingle.end());
+  if (!fExpression.Evaluate(GetUserData(), fSingleCollection, fSingleKeep))
+    return false;
+  return fSingleKeep[0] != 0;
+}
+
+bool Algorithms::SelectExpression::FilterCollection (const ParticleCollection &particles, 
+    std::vector<char> &keep) {
+  // a missing value leaves nothing selected
+  fExpression.Evaluate(GetUserData(), particles, keep);
+  return true;
+}
+
+} /* HAL */ 
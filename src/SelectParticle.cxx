@@ -8,27 +8,46 @@ namespace HAL
  * */
 void internal::FilterParticleAlgo::Exec (Option_t* /*option*/) {
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName());
   HAL::GenericData *input_data = NULL;
 
-  data->SetValue(GetName(), gen_data);
+  if (fOutput == nullptr)
+    fOutput = new GenericData(GetName());
+  else
+    fOutput->Reset();
+
+  HAL::GenericData *gen_data = fOutput;
+
+  data->SetValue(GetNameKey(), gen_data);
 
-  if (data->Exists(fInput)) 
-    input_data = (GenericData*)data->GetTObject(fInput);
+  if (data->Exists(fInputKey)) 
+    input_data = (GenericData*)data->GetTObject(fInputKey);
   else
     return;
+  gen_data->SetSource(input_data);
 
-  for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
-       particle != input_data->GetParticleEnd(); ++ particle) {
-    if (FilterPredicate(*particle))
-      gen_data->AddParticle(*particle);
+  ParticleCollection &particles = input_data->GetCollection();
+
+  if (FilterCollection(particles, fKeep)) {
+    for (size_t i = 0; i < particles.GetSize(); ++i) {
+      if (fKeep[i])
+        gen_data->AddSelected(i);
+    }
+  }
+  else {
+    fInputData = input_data;
+    for (size_t i = 0; i < input_data->GetNParticles(); ++i) {
+      if (FilterPredicate(input_data->GetParticle(i)))
+        gen_data->AddSelected(i);
+    }
+    fInputData = nullptr;
   }
 
   IncreaseCounter(gen_data->GetNParticles());
 }
 
 void internal::FilterParticleAlgo::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
+  if (fOutput != nullptr)
+    fOutput->Reset();
 }
 
 
@@ -36,164 +55,407 @@ void internal::FilterParticleAlgo::Clear (Option_t* /*option*/) {
 
 Algorithms::SelectParticle::SelectParticle (TString name, TString title, TString input, 
     TString property, TString op, double value) : 
-  FilterParticleAlgo(name, title, input), 
-  fPt(false), fM(false), fE(false), fEt(false), fP3(false), fEta(false), 
-  fPhi(false), fCharge(false), fID(false), fAttribute(false), fEqual(false), fNotEqual(false), 
-  fLessThan(false), fGreaterThan(false), fLessThanEqual(false), 
-  fGreaterThanEqual(false), fIn(false), fOut(false), fSingleEnd(true), fWindow(false), 
-  fList(false), fProperty(property) {
+  FilterParticleAlgo(name, title, input), fHighLimit(value), fLowLimit(value), 
+  fSource(kKinematicValue), fKinematic(GenericParticle::kPt), fComparison(kUnknown), 
+  fProperty(property), fPropertyKey(property), fLeader(nullptr), fPrevious(nullptr), 
+  fFusedEvent(0), fChainInput(nullptr) {
 
   Setup();
 
-  if (op.EqualTo("==") || op.EqualTo("=")) {
-    fEqual = true;
-    fLowLimit = value;
-  }
-  else if (op.EqualTo("!=")) {
-    fNotEqual = true;
-    fLowLimit = value;
-  }
-  else if (op.EqualTo(">")) {
-    fGreaterThan = true;
-    fLowLimit = value;
-  }
-  else if (op.EqualTo("<")) {
-    fLessThan = true;
-    fHighLimit = value;
-  }
-  else if (op.EqualTo(">=")) {
-    fGreaterThanEqual = true;
-    fLowLimit = value;
-  }
-  else if (op.EqualTo("<=")) {
-    fLessThanEqual = true;
-    fHighLimit = value;
-  }
+  if (op.EqualTo("==") || op.EqualTo("="))
+    fComparison = kEqual;
+  else if (op.EqualTo("!="))
+    fComparison = kNotEqual;
+  else if (op.EqualTo(">"))
+    fComparison = kGreaterThan;
+  else if (op.EqualTo("<"))
+    fComparison = kLessThan;
+  else if (op.EqualTo(">="))
+    fComparison = kGreaterThanEqual;
+  else if (op.EqualTo("<="))
+    fComparison = kLessThanEqual;
 }
 
 Algorithms::SelectParticle::SelectParticle (TString name, TString title, TString input, 
     TString property, TString inclusion, double low, double high) : 
-  FilterParticleAlgo(name, title, input), 
-  fHighLimit(high), fLowLimit(low), 
-  fPt(false), fM(false), fE(false), fEt(false), fP3(false), fEta(false), 
-  fPhi(false), fCharge(false), fID(false), fAttribute(false), fEqual(false), fNotEqual(false), 
-  fLessThan(false), fGreaterThan(false), fLessThanEqual(false), 
-  fGreaterThanEqual(false), fIn(false), fOut(false), fSingleEnd(false), fWindow(true), 
-  fList(false), fProperty(property) {
+  FilterParticleAlgo(name, title, input), fHighLimit(high), fLowLimit(low), 
+  fSource(kKinematicValue), fKinematic(GenericParticle::kPt), fComparison(kUnknown), 
+  fProperty(property), fPropertyKey(property), fLeader(nullptr), fPrevious(nullptr), 
+  fFusedEvent(0), fChainInput(nullptr) {
 
   Setup();
 
   if (inclusion.EqualTo("inclusive", TString::kIgnoreCase) || 
       inclusion.EqualTo("in", TString::kIgnoreCase))
-    fIn = true;
+    fComparison = kInside;
   else if (inclusion.EqualTo("exclusive", TString::kIgnoreCase) || 
            inclusion.EqualTo("out", TString::kIgnoreCase))
-    fOut = true;
+    fComparison = kOutside;
 }
 
 Algorithms::SelectParticle::SelectParticle (TString name, TString title, TString input, 
     TString property, int length, ...) : 
-  FilterParticleAlgo(name, title, input), 
-  fPt(false), fM(false), fE(false), fEt(false), fP3(false), fEta(false), 
-  fPhi(false), fCharge(false), fID(false), fAttribute(false), fEqual(false), fNotEqual(false), 
-  fLessThan(false), fGreaterThan(false), fLessThanEqual(false), 
-  fGreaterThanEqual(false), fIn(false), fOut(false), fSingleEnd(false), fWindow(false), 
-  fList(true), fProperty(property) {
+  FilterParticleAlgo(name, title, input), fHighLimit(0.0), fLowLimit(0.0), 
+  fSource(kKinematicValue), fKinematic(GenericParticle::kPt), fComparison(kInList), 
+  fProperty(property), fPropertyKey(property), fLeader(nullptr), fPrevious(nullptr), 
+  fFusedEvent(0), fChainInput(nullptr) {
 
   Setup();
 
   va_list arguments;  // store the variable list of arguments
   va_start (arguments, length); // initializing arguments to store all values after length
   for (long long i = 0; i < length; ++i) {
-    if (fID)
-      fListValues.push_back(va_arg(arguments, int));
+    double value;
+    if (fSource == kIDValue)
+      value = va_arg(arguments, int);
     else
-      fListValues.push_back(va_arg(arguments, double));
+      value = va_arg(arguments, double);
+    // NaN never compares equal, so it can't select anything
+    if (value == value)
+      fListValues.push_back(value);
   }
   va_end(arguments); // cleans up the list
+  std::sort(fListValues.begin(), fListValues.end());
+  fListValues.erase(std::unique(fListValues.begin(), fListValues.end()), fListValues.end());
 }
 
 void Algorithms::SelectParticle::Setup () {
   if (fProperty.EqualTo("pt", TString::kIgnoreCase))
-    fPt = true;
+    fKinematic = GenericParticle::kPt;
   else if (fProperty.EqualTo("m", TString::kIgnoreCase))
-    fM = true;
+    fKinematic = GenericParticle::kM;
   else if (fProperty.EqualTo("e", TString::kIgnoreCase))
-    fE = true;
+    fKinematic = GenericParticle::kE;
   else if (fProperty.EqualTo("et", TString::kIgnoreCase))
-    fEt = true;
+    fKinematic = GenericParticle::kEt;
   else if (fProperty.EqualTo("p3", TString::kIgnoreCase))
-    fP3 = true;
+    fKinematic = GenericParticle::kP3;
   else if (fProperty.EqualTo("eta", TString::kIgnoreCase))
-    fEta = true;
+    fKinematic = GenericParticle::kEta;
   else if (fProperty.EqualTo("phi", TString::kIgnoreCase))
-    fPhi = true;
+    fKinematic = GenericParticle::kPhi;
   else if (fProperty.EqualTo("charge", TString::kIgnoreCase))
-    fCharge = true;
+    fSource = kChargeValue;
   else if (fProperty.EqualTo("id", TString::kIgnoreCase))
-    fID = true;
+    fSource = kIDValue;
+  else
+    fSource = kAttributeValue;
+}
+
+void Algorithms::SelectParticle::Exec (Option_t *option) {
+  if (!fFollowers.empty()) {
+    PrepareFused();
+    PublishFused();
+    return;
+  }
+  // followers fall back to a selection of their own if the chain 
+  // wasn't evaluated for this event
+  if (fLeader != nullptr && fFusedEvent != fLeader->fFusedEvent && 
+      fPrevious->fFusedEvent == fLeader->fFusedEvent) {
+    PublishFused();
+    return;
+  }
+  FilterParticleAlgo::Exec(option);
+}
+
+void Algorithms::SelectParticle::Clear (Option_t *option) {
+  FilterParticleAlgo::Clear(option);
+  if (fLeader == nullptr && fFollowers.empty())
+    return;
+  // the rows refer to this event's particles
+  GetUserData()->SetProvider(GetNameKey(), nullptr);
+  fChainInput = nullptr;
+  fRows.clear();
+}
+
+void Algorithms::SelectParticle::Fuse (Algorithm *previous) {
+  SelectParticle *select = dynamic_cast<SelectParticle*>(previous);
+
+  // attribute columns may be incomplete for particles the previous 
+  // selection rejects, so those selections are left alone
+  if (select == nullptr || fLeader != nullptr || !fFollowers.empty() || 
+      !fInput.EqualTo(select->GetName()) || 
+      fSource == kAttributeValue || select->fSource == kAttributeValue || 
+      fComparison == kUnknown || select->fComparison == kUnknown)
+    return;
+  fPrevious = select;
+  fLeader = select->fLeader != nullptr ? select->fLeader : select;
+  fLeader->fFollowers.push_back(this);
+}
+
+/*
+ * Evaluate the whole chain: the leader tests every particle of its input,
+ * each follower only the rows kept by the selection before it
+ * */
+void Algorithms::SelectParticle::PrepareFused () {
+  HAL::AnalysisData *data = GetUserData();
+
+  ++fFusedEvent;
+  fChainInput = nullptr;
+  fRows.clear();
+  if (data->Exists(fInputKey))
+    fChainInput = (GenericData*)data->GetTObject(fInputKey);
+
+  if (fChainInput == nullptr) {
+    for (std::vector<SelectParticle*>::iterator follower = fFollowers.begin();
+         follower != fFollowers.end(); ++follower)
+      (*follower)->fRows.clear();
+    return;
+  }
+
+  ParticleCollection &particles = fChainInput->GetCollection();
+
+  FilterCollection(particles, fKeep);
+  for (size_t i = 0; i < fKeep.size(); ++i) {
+    if (fKeep[i])
+      fRows.push_back(i);
+  }
+  IncreaseCounter(fRows.size());
+
+  for (std::vector<SelectParticle*>::iterator follower = fFollowers.begin();
+       follower != fFollowers.end(); ++follower)
+    (*follower)->FilterRows(particles, (*follower)->fPrevious->fRows, (*follower)->fRows);
+}
+
+/*
+ * Publish the name of a chained selection; the output is only filled if 
+ * something requests it (see Provide)
+ * */
+void Algorithms::SelectParticle::PublishFused () {
+  HAL::AnalysisData *data = GetUserData();
+
+  if (fLeader != nullptr) {
+    fFusedEvent = fLeader->fFusedEvent;
+    IncreaseCounter(fRows.size());
+  }
+  data->SetProvider(GetNameKey(), this);
+  data->RemoveData(GetNameKey());
+}
+
+void Algorithms::SelectParticle::Provide (HAL::AnalysisData *data) {
+  HAL::GenericData *input_data = fLeader != nullptr ? fLeader->fChainInput : fChainInput;
+
+  if (fOutput == nullptr)
+    fOutput = new GenericData(GetName());
   else
-    fAttribute = true;
+    fOutput->Reset();
+
+  HAL::GenericData *gen_data = fOutput;
+
+  data->SetValue(GetNameKey(), gen_data);
+  if (input_data == nullptr)
+    return;
+  gen_data->SetSource(input_data);
+  for (std::vector<size_t>::iterator row = fRows.begin(); row != fRows.end(); ++row)
+    gen_data->AddSelected(*row);
+}
+
+namespace {
+
+/*
+ * One functor per comparison so every column loop is a single
+ * branch-free expression the compiler can inline and vectorize
+ * */
+struct IsEqual {
+  IsEqual (double value) : fValue(value) {}
+  bool operator() (double x) const {return x == fValue;}
+  double fValue;
+};
+
+struct IsNotEqual {
+  IsNotEqual (double value) : fValue(value) {}
+  bool operator() (double x) const {return x != fValue;}
+  double fValue;
+};
+
+struct IsLess {
+  IsLess (double value) : fValue(value) {}
+  bool operator() (double x) const {return x < fValue;}
+  double fValue;
+};
+
+struct IsGreater {
+  IsGreater (double value) : fValue(value) {}
+  bool operator() (double x) const {return x > fValue;}
+  double fValue;
+};
+
+struct IsLessEqual {
+  IsLessEqual (double value) : fValue(value) {}
+  bool operator() (double x) const {return x <= fValue;}
+  double fValue;
+};
+
+struct IsGreaterEqual {
+  IsGreaterEqual (double value) : fValue(value) {}
+  bool operator() (double x) const {return x >= fValue;}
+  double fValue;
+};
+
+struct IsInside {
+  IsInside (double low, double high) : fLow(low), fHigh(high) {}
+  bool operator() (double x) const {return (x <= fHigh) & (x >= fLow);}
+  double fLow, fHigh;
+};
+
+// the window edges belong to both the inclusive and the exclusive selection
+struct IsOutside {
+  IsOutside (double low, double high) : fLow(low), fHigh(high) {}
+  bool operator() (double x) const {return (x <= fLow) | (x >= fHigh);}
+  double fLow, fHigh;
+};
+
+struct IsInList {
+  IsInList (const std::vector<double> &values) : fValues(values) {}
+  bool operator() (double x) const {
+    std::vector<double>::const_iterator it = std::lower_bound(fValues.begin(), fValues.end(), x);
+    return it != fValues.end() && *it == x;
+  }
+  const std::vector<double> &fValues;
+};
+
+template <class T>
+void GatherRows (const T *column, const std::vector<size_t> &rows, std::vector<double> &values) {
+  for (size_t k = 0; k < rows.size(); ++k)
+    values[k] = (double)column[rows[k]];
+}
+
+template <class Op, class T>
+void ApplyColumn (Op op, const T *property, size_t n, std::vector<char> &keep) {
+  char *out = keep.data();
+  for (size_t i = 0; i < n; ++i)
+    out[i] = op((double)property[i]);
+}
+
+}
+
+bool Algorithms::SelectParticle::Test (double property) {
+  switch (fComparison) {
+    case kEqual:            return IsEqual(fLowLimit)(property);
+    case kNotEqual:         return IsNotEqual(fLowLimit)(property);
+    case kLessThan:         return IsLess(fHighLimit)(property);
+    case kGreaterThan:      return IsGreater(fLowLimit)(property);
+    case kLessThanEqual:    return IsLessEqual(fHighLimit)(property);
+    case kGreaterThanEqual: return IsGreaterEqual(fLowLimit)(property);
+    case kInside:           return IsInside(fLowLimit, fHighLimit)(property);
+    case kOutside:          return IsOutside(fLowLimit, fHighLimit)(property);
+    case kInList:           return IsInList(fListValues)(property);
+    default:                break;
+  }
+  throw HAL::HALException(GetName().Prepend("Couldn't determine how to filter: "));
 }
 
 bool Algorithms::SelectParticle::FilterPredicate(ParticlePtr particle) {
-  TLorentzVector *vec = particle->GetP();
   double property = 0.0;
 
-  if (fPt)
-    property = vec->Pt();
-  else if (fM)
-    property = vec->M();
-  else if (fE)
-    property = vec->E();
-  else if (fEt)
-    property = vec->Et();
-  else if (fP3)
-    property = vec->P();
-  else if (fEta)
-    property = vec->Eta();
-  else if (fPhi)
-    property = vec->Phi();
-  else if (fID)
+  if (fSource == kKinematicValue)
+    property = particle->GetKinematic(fKinematic);
+  else if (fSource == kIDValue)
     property = (double)particle->GetID();
-  else if (fCharge)
+  else if (fSource == kChargeValue)
     property = (double)particle->GetCharge();
-  else if (fAttribute && particle->HasAttribute(fProperty))
-    property = particle->GetAttribute(fProperty);
+  else if (fInputData != nullptr && fInputData->HasAttribute(particle, fPropertyKey))
+    property = fInputData->GetAttribute(particle, fPropertyKey);
+  else if (fInputData == nullptr && particle->HasAttribute(fPropertyKey))
+    property = particle->GetAttribute(fPropertyKey);
   else 
     throw HAL::HALException(GetName().Prepend("Couldn't determine property to filter: "));
 
-  if (fSingleEnd) {
-    if (fEqual) 
-      return (property == fLowLimit);
-    else if (fNotEqual) 
-      return (property != fLowLimit);
-    else if (fGreaterThan)
-      return (property > fLowLimit);
-    else if (fLessThan)
-      return (property < fHighLimit);
-    else if (fGreaterThanEqual)
-      return (property >= fLowLimit);
-    else if (fLessThanEqual)
-      return (property <= fHighLimit);
+  return Test(property);
+}
+
+bool Algorithms::SelectParticle::FilterCollection (const ParticleCollection &particles, 
+    std::vector<char> &keep) {
+  size_t n = particles.GetSize();
+
+  keep.assign(n, 0);
+  if (n == 0)
+    return true;
+
+  if (fSource == kAttributeValue) {
+    if (!particles.GatherAttribute(fPropertyKey, fAttributeValues))
+      throw HAL::HALException(GetName().Prepend("Couldn't determine property to filter: "));
+    Compare(fAttributeValues.data(), n, keep);
+  }
+  else if (fSource == kIDValue)
+    Compare(particles.GetID(), n, keep);
+  else if (fSource == kChargeValue)
+    Compare(particles.GetCharge(), n, keep);
+  else if (fKinematic == GenericParticle::kPt)
+    Compare(particles.GetPt(), n, keep);
+  else if (fKinematic == GenericParticle::kM)
+    Compare(particles.GetM(), n, keep);
+  else if (fKinematic == GenericParticle::kE)
+    Compare(particles.GetE(), n, keep);
+  else if (fKinematic == GenericParticle::kEta)
+    Compare(particles.GetEta(), n, keep);
+  else if (fKinematic == GenericParticle::kPhi)
+    Compare(particles.GetPhi(), n, keep);
+  else {
+    // no column for this quantity: gather it from the particles' caches
+    fValues.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      fValues[i] = particles.GetParticle(i)->GetKinematic(fKinematic);
+    Compare(fValues.data(), n, keep);
   }
+  return true;
+}
+
+void Algorithms::SelectParticle::FilterRows (const ParticleCollection &particles, 
+    const std::vector<size_t> &rows, std::vector<size_t> &passed) {
+  size_t n = rows.size();
+
+  passed.clear();
+  if (n == 0)
+    return;
 
-  else if (fWindow) {
-    if (fIn)
-      return (property <= fHighLimit && property >= fLowLimit);
-    else if (fOut)
-      return (property >= fHighLimit && property <= fLowLimit);
+  fValues.resize(n);
+  if (fSource == kIDValue)
+    GatherRows(particles.GetID(), rows, fValues);
+  else if (fSource == kChargeValue)
+    GatherRows(particles.GetCharge(), rows, fValues);
+  else if (fKinematic == GenericParticle::kPt)
+    GatherRows(particles.GetPt(), rows, fValues);
+  else if (fKinematic == GenericParticle::kM)
+    GatherRows(particles.GetM(), rows, fValues);
+  else if (fKinematic == GenericParticle::kE)
+    GatherRows(particles.GetE(), rows, fValues);
+  else if (fKinematic == GenericParticle::kEta)
+    GatherRows(particles.GetEta(), rows, fValues);
+  else if (fKinematic == GenericParticle::kPhi)
+    GatherRows(particles.GetPhi(), rows, fValues);
+  else {
+    for (size_t k = 0; k < n; ++k)
+      fValues[k] = particles.GetParticle(rows[k])->GetKinematic(fKinematic);
   }
 
-  else if (fList) {
-    for (std::vector<double>::iterator val = fListValues.begin();
-        val != fListValues.end(); ++val) {
-      if (property == *val)
-        return true;
-    }
-    return false;
+  fKeep.resize(n);
+  Compare(fValues.data(), n, fKeep);
+  for (size_t k = 0; k < n; ++k) {
+    if (fKeep[k])
+      passed.push_back(rows[k]);
   }
+}
 
+/*
+ * Same logic as Test, applied to a whole column: the comparison is
+ * picked once per column instead of once per particle
+ * */
+template <class T>
+void Algorithms::SelectParticle::Compare (const T *property, size_t n, 
+    std::vector<char> &keep) {
+  switch (fComparison) {
+    case kEqual:            ApplyColumn(IsEqual(fLowLimit), property, n, keep); return;
+    case kNotEqual:         ApplyColumn(IsNotEqual(fLowLimit), property, n, keep); return;
+    case kLessThan:         ApplyColumn(IsLess(fHighLimit), property, n, keep); return;
+    case kGreaterThan:      ApplyColumn(IsGreater(fLowLimit), property, n, keep); return;
+    case kLessThanEqual:    ApplyColumn(IsLessEqual(fHighLimit), property, n, keep); return;
+    case kGreaterThanEqual: ApplyColumn(IsGreaterEqual(fLowLimit), property, n, keep); return;
+    case kInside:           ApplyColumn(IsInside(fLowLimit, fHighLimit), property, n, keep); return;
+    case kOutside:          ApplyColumn(IsOutside(fLowLimit, fHighLimit), property, n, keep); return;
+    case kInList:           ApplyColumn(IsInList(fListValues), property, n, keep); return;
+    default:                break;
+  }
   throw HAL::HALException(GetName().Prepend("Couldn't determine how to filter: "));
 }
 
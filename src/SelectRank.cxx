@@ -8,64 +8,62 @@ namespace HAL
  * */
 void internal::NthElementAlgo::Exec (Option_t* /*option*/) {
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName());
   HAL::GenericData *input_data = NULL;
   HAL::GenericData *original_data = NULL;
-  long long n, norigin;
+  long long n;
+  size_t norigin;
 
-  data->SetValue(GetName(), gen_data);
+  if (fOutput == nullptr)
+    fOutput = new GenericData(GetName());
+  else
+    fOutput->Reset();
+
+  HAL::GenericData *gen_data = fOutput;
 
-  if (data->Exists(fInput)) 
-    input_data = (GenericData*)data->GetTObject(fInput);
+  data->SetValue(GetNameKey(), gen_data);
+
+  if (data->Exists(fInputKey)) 
+    input_data = (GenericData*)data->GetTObject(fInputKey);
   else
     return;
-
-  // Need to look for actual owner for sorting purposes
-  if (input_data->IsOwner())
-    original_data = input_data;
-  else if (input_data->GetNParticles() > 0)
-    original_data = (GenericData*)data->GetTObject(input_data->GetOwner());
-  else return;
+  gen_data->SetSource(input_data);
 
   n = input_data->GetNParticles();
-  norigin = original_data->GetNParticles();
-  if (n < fN)
+  if (n < fN || n == 0)
     return;
 
-  // Create sorted list for original data
-  if (!original_data->HasParticles(SortTag())) {
-    HAL::ParticlePtrs sorted_particles;
+  // Rank within the actual owner (the rows of its attribute columns are 
+  // the particles' positions in it)
+  original_data = input_data->GetParticle(0)->GetAttributeData();
+  if (original_data == nullptr)
+    return;
+  norigin = original_data->GetNParticles();
 
-    for (unsigned i = 0; i < norigin; ++i) 
-      sorted_particles.push_back(original_data->GetParticle(i));
-    Sort(sorted_particles);
-    original_data->SetParticles(SortTag(), sorted_particles);
+  // mark the owner positions of the input (position in input + 1)
+  fMembers.assign(norigin, 0);
+  for (long long i = 0; i < n; ++i) {
+    ParticlePtr particle = input_data->GetParticle(i);
+    if (particle->GetAttributeData() == original_data)
+      fMembers[particle->GetAttributeRow()] = i + 1;
   }
 
-  // loop over the sorted list and find the fN-th ranked member in fInput
-  ParticlePtr result = NULL;
-  ParticlePtrs sorted_list = original_data->GetParticles(SortTag());
+  // walk the owner's (shared) sorted order and take the fN-th input member
+  const std::vector<size_t> &sorted = original_data->GetSortedIndices(SortKinematic(), SortDescending());
   long long count = 0;
-  for (ParticlePtrsIt particle = sorted_list.begin(); particle != sorted_list.end(); ++ particle) {
-    for (ParticlePtrsIt my_particle = input_data->GetParticleBegin(); 
-         my_particle != input_data->GetParticleEnd(); ++ my_particle) {
-      if (*particle == *my_particle) {
-        if (++count == fN) {
-          result = *particle;
-          break;
-        }
-      }
-    }
-    if (result != NULL)
+  for (size_t k = 0; k < sorted.size(); ++k) {
+    size_t member = fMembers[sorted[k]];
+    if (member != 0 && ++count == fN) {
+      gen_data->AddSelected(member - 1);
       break;
+    }
   }
 
-  gen_data->AddParticle(result);
   IncreaseCounter(gen_data->GetNParticles());
 }
 
 void internal::NthElementAlgo::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
+  if (fOutput != nullptr)
+    fOutput->Reset();
 }
 
 
@@ -98,53 +96,26 @@ Algorithms::SelectRank::SelectRank (TString name, TString title,
     fLow = true;
 }
 
-TString Algorithms::SelectRank::SortTag () {
+GenericParticle::Kinematic Algorithms::SelectRank::SortKinematic () {
   if (fPt)
-    return "4v_pt";
+    return GenericParticle::kPt;
   if (fM)
-    return "4v_m";
+    return GenericParticle::kM;
   if (fE)
-    return "4v_e";
+    return GenericParticle::kE;
   if (fEt)
-    return "4v_et";
+    return GenericParticle::kEt;
   if (fP3)
-    return "4v_p3";
+    return GenericParticle::kP3;
   throw HALException(GetName().Prepend("Couldn't determine sorting type: "));
 }
 
-bool Algorithms::SelectRank::operator() (ParticlePtr lhs, ParticlePtr rhs) {
-  TLorentzVector *lhs_vec = lhs->GetP();
-  TLorentzVector *rhs_vec = rhs->GetP();
-
-  if (fHigh) {
-    if (fPt)
-      return (lhs_vec->Pt() > rhs_vec->Pt());
-    if (fM)
-      return (lhs_vec->M() > rhs_vec->M());
-    if (fE)
-      return (lhs_vec->E() > rhs_vec->E());
-    if (fEt)
-      return (lhs_vec->Et() > rhs_vec->Et());
-    if (fP3)
-      return (lhs_vec->P() > rhs_vec->P());
-  }
-  else if (fLow) {
-    if (fPt)
-      return (lhs_vec->Pt() < rhs_vec->Pt());
-    if (fM)
-      return (lhs_vec->M() < rhs_vec->M());
-    if (fE)
-      return (lhs_vec->E() < rhs_vec->E());
-    if (fEt)
-      return (lhs_vec->Et() < rhs_vec->Et());
-    if (fP3)
-      return (lhs_vec->P() < rhs_vec->P());
-  }
+bool Algorithms::SelectRank::SortDescending () {
+  if (fHigh)
+    return true;
+  if (fLow)
+    return false;
   throw HALException(GetName().Prepend("Couldn't determine sorting information: "));
 }
 
-void Algorithms::SelectRank::Sort (ParticlePtrs &sl) {
-  std::stable_sort(sl.begin(), sl.end(), *this);
-}
-
 } /* HAL */ 
@@ -8,42 +8,87 @@ namespace HAL
  * */
 void internal::FilterRefParticleAlgo::Exec (Option_t* /*option*/) {
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName());
   HAL::GenericData *input_data = NULL;
   HAL::GenericData *others_data = NULL;
   HAL::ParticlePtr  reference;
 
-  data->SetValue(GetName(), gen_data);
+  if (fOutput == nullptr)
+    fOutput = new GenericData(GetName());
+  else
+    fOutput->Reset();
+
+  HAL::GenericData *gen_data = fOutput;
+
+  data->SetValue(GetNameKey(), gen_data);
 
-  if (data->Exists(fInput) && data->Exists(fOthers)) {
-    input_data = (GenericData*)data->GetTObject(fInput);
-    others_data = (GenericData*)data->GetTObject(fOthers);
+  if (data->Exists(fInputKey) && data->Exists(fOthersKey)) {
+    input_data = (GenericData*)data->GetTObject(fInputKey);
+    others_data = (GenericData*)data->GetTObject(fOthersKey);
   }
   else
     return;
+  gen_data->SetSource(others_data);
+
+  double reach = PredicateReach();
+
+  if (reach > 0.0 && input_data->GetNParticles() > 0) {
+    ParticleCollection &references = input_data->GetCollection();
+    ParticleCollection &others = others_data->GetCollection();
+    const double *eta = others.GetEta(), *phi = others.GetPhi();
+
+    // references farther than the reach always pass, so only the neighbouring
+    // cells are tested (the small margin covers rounding in DeltaR)
+    fGrid.Build(references.GetEta(), references.GetPhi(), references.GetSize(), 
+                reach * (1.0 + 1.0e-6) + 1.0e-12);
+    for (size_t i = 0; i < others.GetSize(); ++i) {
+      ParticlePtr particle = others.GetParticle(i);
+      bool add_particle = true;
+      fGrid.Neighbours(eta[i], phi[i], fCandidates);
+      for (size_t c = 0; c < fCandidates.size(); ++c) {
+        reference = references.GetParticle(fCandidates[c]);
+        if (IsSameParticle(reference, particle))
+          continue;
+        if (!FilterPredicate(reference, particle)) {
+          add_particle = false;
+          break;
+        }
+      }
+      if (add_particle)
+        gen_data->AddSelected(i);
+    }
+    IncreaseCounter(gen_data->GetNParticles());
+    return;
+  }
 
-  for (ParticlePtrsIt particle = others_data->GetParticleBegin(); 
-       particle != others_data->GetParticleEnd(); ++ particle) {
+  for (size_t i = 0; i < others_data->GetNParticles(); ++i) {
+    ParticlePtr particle = others_data->GetParticle(i);
     bool add_particle = true;
     for (ParticlePtrsIt ref_particle = input_data->GetParticleBegin(); 
          ref_particle != input_data->GetParticleEnd(); ++ ref_particle) {
       reference = *ref_particle;
-      if (reference == *particle || reference->HasSameParticles("parents", *particle))
+      if (IsSameParticle(reference, particle))
         continue;
-      if (!FilterPredicate(reference, *particle)) {
+      if (!FilterPredicate(reference, particle)) {
         add_particle = false;
         break;
       }
     }
     if (add_particle)
-      gen_data->AddParticle(*particle);
+      gen_data->AddSelected(i);
   }
 
   IncreaseCounter(gen_data->GetNParticles());
 }
 
 void internal::FilterRefParticleAlgo::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
+  if (fOutput != nullptr)
+    fOutput->Reset();
+}
+
+bool internal::FilterRefParticleAlgo::IsSameParticle (ParticlePtr reference, ParticlePtr particle) {
+  // particles without parents would otherwise all look alike
+  return reference == particle || 
+         (reference->GetNParticles(fParentsKey) != 0 && reference->HasSameParticles(fParentsKey, particle));
 }
 
 
@@ -98,14 +143,12 @@ Algorithms::SelectRefParticle::SelectRefParticle (TString name, TString title, T
 }
 
 bool Algorithms::SelectRefParticle::FilterPredicate (HAL::ParticlePtr p_ref, HAL::ParticlePtr particle) {
-  TLorentzVector *ref = p_ref->GetP();
-  TLorentzVector *vec = particle->GetP();
   double val = 0.0;
 
   if (fDeltaR)
-    val = ref->DeltaR(*vec);
+    val = p_ref->DeltaR(particle);
   else if (fDeltaPhi)
-    val = ref->DeltaPhi(*vec);
+    val = p_ref->DeltaPhi(particle);
 
   if (fWindow) {
     if (fIn)
@@ -120,4 +163,11 @@ bool Algorithms::SelectRefParticle::FilterPredicate (HAL::ParticlePtr p_ref, HAL
   throw HAL::HALException(GetName().Prepend("Couldn't determine how to filter: "));
 }
 
+double Algorithms::SelectRefParticle::PredicateReach () {
+  // only an exclusive cone passes every reference outside of it
+  if (fDeltaR && fOut && !fWindow)
+    return fLowLimit;
+  return 0.0;
+}
+
 } /* HAL */ 
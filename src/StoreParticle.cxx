@@ -7,9 +7,11 @@ namespace HAL
  * Generic class
  * */
 internal::ParticlesTLVStore::ParticlesTLVStore (TString name, TString title, TString input, TString bname) :
-  Algorithm(name, title), fSearchedForAttributes(false), fBranchName(bname), fInput(input) {
+  Algorithm(name, title), fUsesAttributes(true), fSearchedForAttributes(false), fBranchName(bname), fInput(input), 
+  fInputKey(input) {
 
   fNParticles = TString::Format("%s_n", fBranchName.Data());
+  fNParticlesKey = DataKey(fNParticles);
 }
 
 void internal::ParticlesTLVStore::Exec (Option_t* /*option*/) {
@@ -18,37 +20,32 @@ void internal::ParticlesTLVStore::Exec (Option_t* /*option*/) {
   HAL::GenericData *input_data = NULL;
   long long i = 0;
 
-  if (data->Exists(fInput))
-    input_data = (GenericData*)data->GetTObject(fInput);
+  if (data->Exists(fInputKey))
+    input_data = (GenericData*)data->GetTObject(fInputKey);
   else
     return;
 
-  if (!fSearchedForAttributes) {
-    i = 0;
+  if (fUsesAttributes && !fSearchedForAttributes) {
+    std::set<TString> names;
+
     fSearchedForAttributes = true;
+    // every attribute present on the first event's particles gets a branch
     for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
-         particle != input_data->GetParticleEnd(); ++ particle) {
-      for (std::map<TString, long double>::iterator attribute = (*particle)->GetAttributes().begin();
-           attribute != (*particle)->GetAttributes().end(); ++attribute) {
-        bool found = false;
-        for (std::map<TString, bool>::iterator stored_attribute = fAttributeFlags.begin();
-             stored_attribute != fAttributeFlags.end(); ++stored_attribute) {
-          if (attribute->first.EqualTo(stored_attribute->first)) found = true;
-        }
-        if (i == 0 || (found && fAttributeFlags[attribute->first])) fAttributeFlags[attribute->first] = true;
-        else fAttributeFlags[attribute->first] = false;
-      }
-      ++i;
-    }
-    for (std::map<TString, bool>::iterator stored_attribute = fAttributeFlags.begin();
-         stored_attribute != fAttributeFlags.end(); ++stored_attribute) {
-      fAttributeLabels[stored_attribute->first] = 
-        TString::Format("%s_%s", fBranchName.Data(), stored_attribute->first.Data());
+         particle != input_data->GetParticleEnd(); ++ particle) 
+      input_data->GetAttributeNames(*particle, names);
+    for (std::set<TString>::iterator name = names.begin(); name != names.end(); ++name) {
+      fAttributeKeys.push_back(DataKey(*name));
+      fAttributeLabels.push_back(TString::Format("%s_%s", fBranchName.Data(), name->Data()));
     }
+    fAttributeValues.resize(fAttributeKeys.size());
   }
 
+  // read each attribute as one column
+  for (size_t k = 0; k < fAttributeKeys.size(); ++k)
+    input_data->GetCollection().GatherAttribute(fAttributeKeys[k], fAttributeValues[k]);
+
   i = 0;
-  output->SetValue(fNParticles, input_data->GetNParticles());
+  output->SetValue(fNParticlesKey, input_data->GetNParticles());
   for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
       particle != input_data->GetParticleEnd(); ++ particle) 
     StoreValue(output, i++, (*particle));
@@ -97,6 +94,8 @@ Algorithms::StoreParticle::StoreParticle (TString name, TString title, TString i
     fAll = true;
   else if (property.EqualTo("attributes", TString::kIgnoreCase))
     fAttributes = true;
+  // only these modes write attribute branches
+  fUsesAttributes = fAll || fAttributes;
 
   fPtLabel = TString::Format("%s_pt", fBranchName.Data());
   fEtLabel = TString::Format("%s_et", fBranchName.Data());
@@ -166,34 +165,32 @@ void  Algorithms::StoreParticle::Init (Option_t* /*option*/) {
 }
 
 void Algorithms::StoreParticle::StoreValue (HAL::AnalysisTreeWriter *output, long long i, HAL::ParticlePtr particle) {
-  TLorentzVector *vec = particle->GetP();
-
   if (fPt) {
-    output->SetValue(fBranchName, vec->Pt(), i);
+    output->SetValue(fBranchName, particle->GetPt(), i);
     return;
   }
   if (fM) {
-    output->SetValue(fBranchName, vec->M(), i);
+    output->SetValue(fBranchName, particle->GetM(), i);
     return;
   }
   if (fE) {
-    output->SetValue(fBranchName, vec->E(), i);
+    output->SetValue(fBranchName, particle->GetE(), i);
     return;
   }
   if (fEt) {
-    output->SetValue(fBranchName, vec->Et(), i);
+    output->SetValue(fBranchName, particle->GetEt(), i);
     return;
   }
   if (fP3) {
-    output->SetValue(fBranchName, vec->P(), i);
+    output->SetValue(fBranchName, particle->GetP3(), i);
     return;
   }
   if (fEta) {
-    output->SetValue(fBranchName, vec->Eta(), i);
+    output->SetValue(fBranchName, particle->GetEta(), i);
     return;
   }
   if (fPhi) {
-    output->SetValue(fBranchName, vec->Phi(), i);
+    output->SetValue(fBranchName, particle->GetPhi(), i);
     return;
   }
   if (fID) {
@@ -205,29 +202,59 @@ void Algorithms::StoreParticle::StoreValue (HAL::AnalysisTreeWriter *output, lon
     return;
   }
   if (fAll) {
-    for (std::map<TString, TString>::iterator it = fAttributeLabels.begin();
-         it != fAttributeLabels.end(); ++it) {
-      output->SetTreeForBranch(fTreeName, it->second);
-      output->SetValue(it->second, particle->GetAttribute(it->first), i);
+    for (size_t k = 0; k < fAttributeKeys.size(); ++k) {
+      output->SetTreeForBranch(fTreeName, fAttributeLabels[k]);
+      output->SetValue(fAttributeLabels[k], fAttributeValues[k][i], i);
     }
-    output->SetValue(fPtLabel, vec->Pt(), i);
-    output->SetValue(fEtaLabel, vec->Eta(), i);
-    output->SetValue(fPhiLabel, vec->Phi(), i);
-    output->SetValue(fMLabel, vec->M(), i);
-    output->SetValue(fELabel, vec->E(), i);
+    output->SetValue(fPtLabel, particle->GetPt(), i);
+    output->SetValue(fEtaLabel, particle->GetEta(), i);
+    output->SetValue(fPhiLabel, particle->GetPhi(), i);
+    output->SetValue(fMLabel, particle->GetM(), i);
+    output->SetValue(fELabel, particle->GetE(), i);
     output->SetValue(fIDLabel, particle->GetID(), i);
     output->SetValue(fChargeLabel, particle->GetCharge(), i);
     return;
   }
   if (fAttributes) {
-    for (std::map<TString, TString>::iterator it = fAttributeLabels.begin();
-         it != fAttributeLabels.end(); ++it) {
-      output->SetTreeForBranch(fTreeName, it->second);
-      output->SetValue(it->second, particle->GetAttribute(it->first), i);
+    for (size_t k = 0; k < fAttributeKeys.size(); ++k) {
+      output->SetTreeForBranch(fTreeName, fAttributeLabels[k]);
+      output->SetValue(fAttributeLabels[k], fAttributeValues[k][i], i);
     }
     return;
   }
   throw HAL::HALException(GetName().Prepend("Couldn't determine what to store: "));
 }
 
+Algorithms::StoreValue::StoreValue (TString name, TString title, TString input, 
+    TString bname, TString tree) :
+  Algorithm(name, title), fInput(input), fBranchName(bname), fTreeName(tree), 
+  fInputKey(input), fBranchKey(bname) {
+}
+
+void  Algorithms::StoreValue::Init (Option_t* /*option*/) {
+  GetUserOutput()->SetTreeForBranch(fTreeName, fBranchName);
+}
+
+void  Algorithms::StoreValue::Exec (Option_t* /*option*/) {
+  HAL::AnalysisData *data = GetUserData();
+  HAL::AnalysisTreeWriter *output = GetUserOutput();
+
+  if (!data->Exists(fInputKey))
+    return;
+
+  HAL::GenericData *input_data = (GenericData*)data->GetTObject(fInputKey);
+  TString ref_type = input_data->GetRefType();
+
+  if (ref_type.EqualTo("bool"))
+    output->SetValue(fBranchKey, data->GetBool(input_data->GetRefName()));
+  else if (ref_type.EqualTo("integer"))
+    output->SetValue(fBranchKey, data->GetInteger(input_data->GetRefName()));
+  else if (ref_type.EqualTo("counting"))
+    output->SetValue(fBranchKey, data->GetCounting(input_data->GetRefName()));
+  else if (ref_type.EqualTo("decimal"))
+    output->SetValue(fBranchKey, data->GetDecimal(input_data->GetRefName()));
+  else
+    throw HAL::HALException(fInput.Copy().Prepend("Couldn't find a value to store in: ").Data());
+}
+
 } /* HAL */ 
@@ -8,13 +8,17 @@ namespace HAL
  * */
 
 Algorithms::VecAddReco::VecAddReco (TString name, TString title, long long length, ...) :
-    Algorithm(name, title), fLength(length) {
+    Algorithm(name, title), fLength(length), fParentsKey("parents"), 
+    fMaxMass(-1.0), fHasCharge(false), fCharge(0.0), fMaxCandidates(0), fWidth(0), 
+    fUnique(64, MaskHash(&fNextMasks, &fWidth), MaskEqual(&fNextMasks, &fWidth)) {
   fParentNames = new const char*[fLength];
   va_list arguments;  // store the variable list of arguments
 
   va_start (arguments, length); // initializing arguments to store all values after length
-  for (long long i = 0; i < fLength; ++i)
+  for (long long i = 0; i < fLength; ++i) {
     fParentNames[i] = va_arg(arguments, const char*);
+    fParentKeys.push_back(DataKey(fParentNames[i]));
+  }
   va_end(arguments); // cleans up the list
 }
 
@@ -22,103 +26,222 @@ Algorithms::VecAddReco::~VecAddReco() {
   delete[] fParentNames;
 }
 
+size_t Algorithms::VecAddReco::MaskHash::operator() (size_t t) const {
+  const unsigned long long *mask = &(*fMasks)[t * *fWidth];
+  unsigned long long h = 14695981039346656037ULL;
+
+  for (size_t w = 0; w < *fWidth; ++w) {
+    h ^= mask[w];
+    h *= 1099511628211ULL;
+  }
+  return (size_t)(h ^ (h >> 32));
+}
+
+bool Algorithms::VecAddReco::MaskEqual::operator() (size_t a, size_t b) const {
+  const unsigned long long *lhs = &(*fMasks)[a * *fWidth];
+  const unsigned long long *rhs = &(*fMasks)[b * *fWidth];
+
+  return std::equal(lhs, lhs + *fWidth, rhs);
+}
+
+bool Algorithms::VecAddReco::Reads (const TString &name) {
+  DataKey key = DataKey::Find(name);
+
+  for (std::vector<DataKey>::iterator parent = fParentKeys.begin(); parent != fParentKeys.end(); ++parent) {
+    if (*parent == key)
+      return true;
+  }
+  return false;
+}
+
 void Algorithms::VecAddReco::Exec (Option_t* /*option*/) {
   HAL::AnalysisData *data = GetUserData();
-  HAL::GenericData *gen_data = new GenericData(GetName(), true);
-  HAL::GenericData *input_data = NULL;
-  std::set<std::set<ParticlePtr> > UniqueTuples;
+  HAL::EventArena *arena = GetEventArena();
+  HAL::GenericData *gen_data = arena->New<GenericData>(GetName(), true);
+  std::vector<HAL::GenericData*> inputs(fLength, (HAL::GenericData*)NULL);
+  std::vector<size_t> first_particle(fLength + 1, 0);
 
-  data->SetValue(GetName(), gen_data);
+  data->SetValue(GetNameKey(), gen_data);
 
-  // Find unique sets of tuples 
-  // (relies on unique particles having unique addresses)
   for (long long i = 0; i < fLength; ++i) {
-    if (data->Exists(fParentNames[i]))
-      input_data = (GenericData*)data->GetTObject(fParentNames[i]);
+    if (data->Exists(fParentKeys[i]))
+      inputs[i] = (GenericData*)data->GetTObject(fParentKeys[i]);
     else
       return;
+    first_particle[i + 1] = first_particle[i] + inputs[i]->GetNParticles();
+  }
 
-    std::set<std::set<ParticlePtr> > NewTuples;
-    if (UniqueTuples.size() == 0) {
-      // Loop over current set of particles and add either the particle 
-      // or its parents to the ntuple
-      for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
-           particle != input_data->GetParticleEnd(); ++ particle) {
-
-        bool                  unique = true;
-        std::set<ParticlePtr> new_tuple;
-
-        if ((*particle)->GetNParticles("parents") > 0) {
-          ParticlePtrs parents = (*particle)->GetParticles("parents");
-          for (ParticlePtrsIt parent = parents.begin(); 
-              parent != parents.end(); ++ parent) {
-            if (new_tuple.insert(*parent).second == false) {
-              unique = false;
-              break;
-            }
-          }
-        }
-        else {
-          if (new_tuple.insert(*particle).second == false)
-            continue;
-        }
+  /*
+   * Give every distinct constituent (a particle's parents or the particle
+   * itself) an id, identifying constituents by origin and origin index (or
+   * by address if they have no origin index)
+   * */
+  fLeafIDs.clear();
+  fLeaves.clear();
+  fInputLeaves.clear();
+  fInputLeafOffsets.assign(1, 0);
+  for (long long i = 0; i < fLength; ++i) {
+    for (ParticlePtrsIt particle = inputs[i]->GetParticleBegin(); 
+         particle != inputs[i]->GetParticleEnd(); ++ particle) {
+      const ParticlePtrs &parents = (*particle)->GetParticles(fParentsKey);
+      size_t nleaves = parents.empty() ? 1 : parents.size();
+
+      for (size_t l = 0; l < nleaves; ++l) {
+        ParticlePtr leaf = parents.empty() ? *particle : parents[l];
+        unsigned long long key = leaf->GetIdentity();
+        std::pair<std::unordered_map<unsigned long long, unsigned>::iterator, bool> id = 
+          fLeafIDs.insert(std::make_pair(key, (unsigned)fLeaves.size()));
+        if (id.second)
+          fLeaves.push_back(leaf);
+        fInputLeaves.push_back(id.first->second);
+      }
+      fInputLeafOffsets.push_back(fInputLeaves.size());
+    }
+  }
 
-        if (unique)
-          NewTuples.insert(new_tuple);
+  // masks, four-vectors and charges of the input particles
+  size_t nparticles = first_particle[fLength];
+  fWidth = (fLeaves.size() + 63) / 64;
+  if (fWidth == 0)
+    fWidth = 1;
+  fInputMasks.assign(nparticles * fWidth, 0);
+  fInputValid.assign(nparticles, 1);
+  fInputSums.assign(nparticles * 4, 0.0);
+  fInputCharges.assign(nparticles, 0.0);
+  for (size_t p = 0; p < nparticles; ++p) {
+    unsigned long long *mask = &fInputMasks[p * fWidth];
+    double *sum = &fInputSums[p * 4];
+    for (size_t l = fInputLeafOffsets[p]; l < fInputLeafOffsets[p + 1]; ++l) {
+      unsigned long long bit = 1ULL << (fInputLeaves[l] % 64);
+      if (mask[fInputLeaves[l] / 64] & bit)
+        fInputValid[p] = 0;
+      mask[fInputLeaves[l] / 64] |= bit;
+
+      ParticlePtr leaf = fLeaves[fInputLeaves[l]];
+      const TLorentzVector *vec = leaf->GetP();
+      sum[0] += vec->Px();
+      sum[1] += vec->Py();
+      sum[2] += vec->Pz();
+      sum[3] += vec->E();
+      fInputCharges[p] += leaf->GetCharge();
+    }
+  }
+
+  // range of the charge the inputs after input i can still add
+  if (fHasCharge) {
+    fChargeLow.assign(fLength + 1, 0.0);
+    fChargeHigh.assign(fLength + 1, 0.0);
+    for (long long i = fLength - 1; i >= 0; --i) {
+      bool any = false;
+      double low = 0.0, high = 0.0;
+      for (size_t p = first_particle[i]; p < first_particle[i + 1]; ++p) {
+        if (!fInputValid[p])
+          continue;
+        if (!any || fInputCharges[p] < low) low = fInputCharges[p];
+        if (!any || fInputCharges[p] > high) high = fInputCharges[p];
+        any = true;
       }
+      fChargeLow[i] = fChargeLow[i + 1] + low;
+      fChargeHigh[i] = fChargeHigh[i + 1] + high;
     }
-    else {
-      for (std::set<std::set<ParticlePtr> >::iterator current_tuple = UniqueTuples.begin();
-           current_tuple != UniqueTuples.end(); ++current_tuple) {
-
-        // Loop over current set of particles and add either the particle 
-        // or its parents to the ntuple
-        for (ParticlePtrsIt particle = input_data->GetParticleBegin(); 
-             particle != input_data->GetParticleEnd(); ++ particle) {
-
-          bool                  unique = true;
-          std::set<ParticlePtr> new_tuple = *current_tuple;
-
-          if ((*particle)->GetNParticles("parents") > 0) {
-            ParticlePtrs parents = (*particle)->GetParticles("parents");
-            for (ParticlePtrsIt parent = parents.begin(); 
-                 parent != parents.end(); ++ parent) {
-              if (new_tuple.insert(*parent).second == false) {
-                unique = false;
-                break;
-              }
-            }
-          }
-          else {
-            if (new_tuple.insert(*particle).second == false)
-              continue;
-          }
+  }
 
-          if (unique)
-            NewTuples.insert(new_tuple);
+  /*
+   * Grow the tuples one input at a time, only keeping extensions that
+   * don't reuse a constituent, that haven't been built already and that
+   * can still satisfy the mass and charge requirements
+   * */
+  double max_mass2 = fMaxMass * fMaxMass;
+  bool full = false;
+
+  fMasks.assign(fWidth, 0);
+  fLast.assign(1, -1);
+  fSums.assign(4, 0.0);
+  fCharges.assign(1, 0.0);
+  for (long long i = 0; i < fLength && !fLast.empty(); ++i) {
+    // repeated input: only take particles after the one taken last
+    bool ordered = (i > 0 && fParentKeys[i] == fParentKeys[i - 1]);
+    bool last_input = (i == fLength - 1);
+    long long n = inputs[i]->GetNParticles();
+
+    fNextMasks.clear();
+    fNextLast.clear();
+    fNextSums.clear();
+    fNextCharges.clear();
+    fUnique.clear();
+    for (size_t t = 0; t < fLast.size() && !full; ++t) {
+      for (long long j = ordered ? fLast[t] + 1 : 0; j < n; ++j) {
+        size_t p = first_particle[i] + j;
+        if (!fInputValid[p])
+          continue;
+
+        const unsigned long long *tuple = &fMasks[t * fWidth];
+        const unsigned long long *mask = &fInputMasks[p * fWidth];
+        bool overlap = false;
+        for (size_t w = 0; w < fWidth && !overlap; ++w)
+          overlap = (tuple[w] & mask[w]) != 0;
+        if (overlap)
+          continue;
+
+        const double *tuple_sum = &fSums[t * 4], *input_sum = &fInputSums[p * 4];
+        double px = tuple_sum[0] + input_sum[0], py = tuple_sum[1] + input_sum[1], 
+               pz = tuple_sum[2] + input_sum[2], e = tuple_sum[3] + input_sum[3];
+        if (fMaxMass >= 0.0 && e * e - px * px - py * py - pz * pz > max_mass2)
+          continue;
+        double charge = fCharges[t] + fInputCharges[p];
+        if (fHasCharge && (charge + fChargeLow[i + 1] > fCharge + 1e-4 || 
+                           charge + fChargeHigh[i + 1] < fCharge - 1e-4))
+          continue;
+
+        size_t candidate = fNextLast.size();
+        for (size_t w = 0; w < fWidth; ++w)
+          fNextMasks.push_back(tuple[w] | mask[w]);
+        std::pair<std::unordered_set<size_t, MaskHash, MaskEqual>::iterator, bool> unique = 
+          fUnique.insert(candidate);
+        if (unique.second) {
+          fNextLast.push_back(j);
+          fNextSums.push_back(px);
+          fNextSums.push_back(py);
+          fNextSums.push_back(pz);
+          fNextSums.push_back(e);
+          fNextCharges.push_back(charge);
+          if (last_input && fMaxCandidates != 0 && fNextLast.size() >= fMaxCandidates) {
+            full = true;
+            break;
+          }
+        }
+        else {
+          // keep the smallest last index so no ordered extension is lost
+          if (j < fNextLast[*unique.first])
+            fNextLast[*unique.first] = j;
+          fNextMasks.resize(candidate * fWidth);
         }
       }
     }
-
-    UniqueTuples = NewTuples;
+    fMasks.swap(fNextMasks);
+    fLast.swap(fNextLast);
+    fSums.swap(fNextSums);
+    fCharges.swap(fNextCharges);
   }
 
-  // Loop over UniqueTuples to make vectors
-  for (std::set<std::set<ParticlePtr> >::iterator current_tuple = UniqueTuples.begin();
-       current_tuple != UniqueTuples.end(); ++current_tuple) {
-    float new_charge = 0.0;
-    HAL::ParticlePtr new_particle = new HAL::Particle(GetName());
-    HAL::ParticlePtrs new_parents;
-    TLorentzVector *vec = new TLorentzVector();
-    for (std::set<ParticlePtr>::iterator particle = current_tuple->begin();
-         particle != current_tuple->end(); ++particle) {
-      new_charge += (*particle)->GetCharge();
-      vec->operator+=(*((*particle)->GetP()));
-      new_parents.push_back(*particle);
+  // Loop over the unique tuples to make vectors
+  for (size_t t = 0; fLength > 0 && t < fLast.size(); ++t) {
+    const unsigned long long *tuple = &fMasks[t * fWidth];
+    const double *sum = &fSums[t * 4];
+    HAL::ParticlePtr new_particle = arena->NewParticle(GetName());
+    TLorentzVector *vec = arena->NewVector();
+
+    vec->SetPxPyPzE(sum[0], sum[1], sum[2], sum[3]);
+    fNewParents.clear();
+    for (size_t w = 0; w < fWidth; ++w) {
+      for (unsigned b = 0; b < 64 && (tuple[w] >> b) != 0; ++b) {
+        if (((tuple[w] >> b) & 1ULL) != 0)
+          fNewParents.push_back(fLeaves[w * 64 + b]);
+      }
     }
-    new_particle->SetCharge(new_charge);
+    new_particle->SetCharge(fCharges[t]);
     new_particle->SetP(vec);
-    new_particle->SetParticles("parents", new_parents);
+    new_particle->SetParticles(fParentsKey, fNewParents);
     gen_data->AddParticle(new_particle);
     new_particle->SetOwnerIndex(gen_data->GetNParticles() - 1);
     new_particle->SetOriginIndex(gen_data->GetNParticles() - 1);
@@ -126,8 +249,4 @@ void Algorithms::VecAddReco::Exec (Option_t* /*option*/) {
   gen_data->SetRefType("none");
 }
 
-void Algorithms::VecAddReco::Clear (Option_t* /*option*/) {
-  delete GetUserData()->GetTObject(GetName());
-}
-
 } /* HAL */ 